@@ -0,0 +1,145 @@
+#!/bin/bash
+
+#SBATCH --time=06:00:00
+#SBATCH -N 2
+#SBATCH -n 16
+
+# Sweeps image sizes, rank counts, scheduling policies and kernels for the
+# Mandelbrot programs and writes one labelled row per configuration.
+#
+# Every point gets WARMUPS untimed runs and REPEATS timed runs and is
+# reported as the median with min, max and standard deviation. Strong
+# scaling speedup is Sequential's median over Dynamic's for the same kernel
+# and size. Weak scaling renders WEAK_BASE x (WEAK_BASE * slaves) so the
+# rows per slave stay fixed, and its (scaled) speedup is Sequential's
+# median for WEAK_BASE x WEAK_BASE times the number of slaves over
+# Dynamic's. Efficiency divides the speedup by the number of ranks, master
+# included.
+#
+# Everything can be overridden from the environment, for example
+#   SIZES="10000 20000" RANKS="2 4 8" REPEATS=3 bash Benchmark.sh
+# Kernels are mandelbrot, julia, burningship or multibrotN (N = 2..8) and
+# policies are dynamic:ROWS or static:ROWS. With VALIDATE=1 the last
+# repeat of every Dynamic point is checked against Sequential with Compare.
+#
+# The default sweep is about 1,350 runs. Sequential takes roughly 75 s at
+# 40000 x 40000, so the Sequential baselines alone need about 25 minutes
+# and the Dynamic points about 3 hours, hence the 6 hour limit. A smaller
+# sweep, such as SIZES="10000 20000" REPEATS=3, fits in well under an hour.
+
+SIZES=${SIZES:-"10000 15000 20000 25000 30000 35000 40000"}
+RANKS=${RANKS:-"2 4 6 8 10 12 14 16"}
+POLICIES=${POLICIES:-"dynamic:1 dynamic:8 static:1 static:8"}
+KERNELS=${KERNELS:-"mandelbrot"}
+REPEATS=${REPEATS:-5}
+WARMUPS=${WARMUPS:-1}
+WEAK_BASE=${WEAK_BASE:-2000}
+VALIDATE=${VALIDATE:-0}
+LAUNCH=${LAUNCH:-"srun -n"}
+OUT=${OUT:-Benchmark}
+
+CSV=$OUT.csv
+JSON=$OUT.json
+SCRATCH=${TMPDIR:-/tmp}/benchmark.$$
+mkdir -p $SCRATCH
+trap "rm -rf $SCRATCH" EXIT
+
+# The fractal options for a kernel name
+kernel_args ()
+{
+    case $1 in
+        multibrot*) echo "-f multibrot -p ${1#multibrot}" ;;
+        *)          echo "-f $1" ;;
+    esac
+}
+
+# The time printed by one run, the last field of its "Total time" line
+run_once ()
+{
+    "$@" | awk '/^Total time/ { print $NF }'
+}
+
+# Runs a command WARMUPS + REPEATS times and prints "median min max stddev"
+measure ()
+{
+    local i
+    for (( i = 0; i < WARMUPS; i++ )); do
+        run_once "$@" > /dev/null
+    done
+    for (( i = 0; i < REPEATS; i++ )); do
+        run_once "$@"
+    done | sort -g | awk '
+        { t[NR] = $1; sum += $1; sumsq += $1 * $1 }
+        END {
+            if ( NR == 0 ) { print "nan nan nan nan"; exit }
+            median = NR % 2 ? t[(NR + 1) / 2] : ( t[NR / 2] + t[NR / 2 + 1] ) / 2
+            mean = sum / NR
+            var = NR > 1 ? ( sumsq - NR * mean * mean ) / ( NR - 1 ) : 0
+            printf "%g %g %g %g\n", median, t[1], t[NR], ( var > 0 ? sqrt ( var ) : 0 )
+        }'
+}
+
+# Appends one row; baseline is the Sequential time the speedup is against
+record ()
+{
+    local scaling=$1 kernel=$2 policy=$3 ranks=$4 width=$5 height=$6 baseline=$7 identical=$8
+    shift 8
+    echo "$scaling,$kernel,$policy,$ranks,$width,$height,$1,$2,$3,$4,$identical" | awk -F, -v base=$baseline '
+        {
+            speedup = $7 > 0 ? base / $7 : 0
+            printf "%s,%s,%s,%d,%d,%d,%g,%g,%g,%g,%g,%g,%g,%s\n", $1, $2, $3, $4, $5, $6, $7, $8, $9, $10,
+                   speedup, speedup / $4, ( $7 > 0 ? $5 * $6 / $7 : 0 ), $11
+        }' >> $CSV
+}
+
+echo "scaling,kernel,policy,ranks,width,height,median_s,min_s,max_s,stddev_s,speedup,efficiency,pixels_per_s,identical" > $CSV
+
+for kernel in $KERNELS; do
+    args=$(kernel_args $kernel)
+
+    # Strong scaling: fixed sizes, more ranks
+    for size in $SIZES; do
+        reference=$SCRATCH/sequential.pim
+        read sequential min max stddev <<< $(measure $LAUNCH 1 ./Sequential $args -o $reference $size $size)
+        record sequential $kernel - 1 $size $size $sequential - $sequential $min $max $stddev
+
+        for policy in $POLICIES; do
+            for ranks in $RANKS; do
+                output=$SCRATCH/dynamic.pim
+                read median min max stddev <<< $(measure $LAUNCH $ranks ./Dynamic $args -m ${policy%:*} -k ${policy#*:} -o $output $size $size)
+                identical=-
+                if [ $VALIDATE -eq 1 ]; then
+                    ./Compare $reference $output > /dev/null && identical=yes || identical=no
+                fi
+                record strong $kernel $policy $ranks $size $size $sequential $identical $median $min $max $stddev
+            done
+        done
+    done
+
+    # Weak scaling: a fixed number of rows per slave
+    read base _ <<< $(measure $LAUNCH 1 ./Sequential $args -o /dev/null $WEAK_BASE $WEAK_BASE)
+    for policy in $POLICIES; do
+        for ranks in $RANKS; do
+            height=$(( WEAK_BASE * ( ranks - 1 ) ))
+            scaled=$(awk -v base=$base -v slaves=$(( ranks - 1 )) 'BEGIN { print base * slaves }')
+            read median min max stddev <<< $(measure $LAUNCH $ranks ./Dynamic $args -m ${policy%:*} -k ${policy#*:} -o /dev/null $WEAK_BASE $height)
+            record weak $kernel $policy $ranks $WEAK_BASE $height $scaled - $median $min $max $stddev
+        done
+    done
+done
+
+# The same rows as JSON, one object per row
+awk -F, '
+    NR == 1 { for ( i = 1; i <= NF; i++ ) key[i] = $i; print "["; next }
+    {
+        printf "%s  {", ( NR > 2 ? ",\n" : "" )
+        for ( i = 1; i <= NF; i++ )
+        {
+            quoted = ( i <= 3 || i == NF ) ? "\"" : ""
+            printf "%s\"%s\": %s%s%s", ( i > 1 ? ", " : "" ), key[i], quoted, $i, quoted
+        }
+        printf "}"
+    }
+    END { print "\n]" }' $CSV > $JSON
+
+echo "Wrote $CSV and $JSON"
@@ -0,0 +1,159 @@
+/** @file Compare.cpp
+  * @brief Compares two P5/P6 renders band by band across threads and reports the differing pixels, MSE and PSNR.
+  *        Exits with 0 when the images are identical, 1 when they differ and 2 on error so it can gate benchmark runs.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "PIMFuncs.h"
+#include <iostream>
+#include <stdlib.h>
+#include <math.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+//Rows handed to a thread at a time
+#define BAND_ROWS   64
+#define PEAK        255.0
+
+using namespace std;
+
+//What one thread found in the bands it compared
+struct BandResult
+{
+    unsigned long long differing;
+    unsigned long long squaredError;
+    int maxDifference;
+};
+
+void compareBands ( const pim_image* first, const pim_image* second, atomic<int>* nextBand, BandResult* result );
+
+int main ( int argc, char** argv )
+{
+    /* Variable Declarations */
+    //The two images being compared
+    pim_image first, second;
+
+    //The number of threads, defaulting to every core
+    int numThreads = thread::hardware_concurrency (  );
+
+    //The next band to hand out
+    atomic<int> nextBand ( 0 );
+
+    /* End of Variable Declarations */
+
+    if ( argc < 3 )
+    {
+        cerr << "Usage: " << argv[0] << " first.pim second.pim [threads]" << endl;
+        return 2;
+    }
+
+    if ( argc > 3 )
+        numThreads = atoi ( argv[3] );
+
+    if ( numThreads < 1 )
+        numThreads = 1;
+
+    if ( !pim_read ( argv[1], first ) || !pim_read ( argv[2], second ) )
+    {
+        cerr << "Could not read " << argv[1] << " and " << argv[2] << " as P5/P6 images" << endl;
+        return 2;
+    }
+
+    if ( first.width != second.width || first.height != second.height || first.channels != second.channels )
+    {
+        cout << "Dimensions differ: " << first.width << "x" << first.height << "x" << first.channels
+             << " vs " << second.width << "x" << second.height << "x" << second.channels << endl;
+        return 1;
+    }
+
+    //Each thread claims bands until none are left
+    vector<BandResult> results ( numThreads );
+    vector<thread> threads;
+
+    for ( int i = 0; i < numThreads; i++ )
+        threads.push_back ( thread ( compareBands, &first, &second, &nextBand, &results[i] ) );
+
+    for ( int i = 0; i < numThreads; i++ )
+        threads[i].join (  );
+
+    //Combine what every thread found
+    BandResult total = { 0, 0, 0 };
+    for ( int i = 0; i < numThreads; i++ )
+    {
+        total.differing += results[i].differing;
+        total.squaredError += results[i].squaredError;
+        if ( results[i].maxDifference > total.maxDifference )
+            total.maxDifference = results[i].maxDifference;
+    }
+
+    double samples = (double)first.rowBytes * first.height;
+    double mse = total.squaredError / samples;
+
+    cout << "Differing samples: " << total.differing << " of " << (unsigned long long)samples << endl;
+    cout << "Max difference: " << total.maxDifference << endl;
+    cout << "MSE: " << mse << endl;
+
+    if ( total.differing == 0 )
+        cout << "PSNR: inf" << endl;
+    else
+        cout << "PSNR: " << 10.0 * log10 ( PEAK * PEAK / mse ) << " dB" << endl;
+
+    pim_close ( first );
+    pim_close ( second );
+
+    return total.differing == 0 ? 0 : 1;
+}
+
+ /**compareBands
+ *@fn void compareBands ( const pim_image* first, const pim_image* second, atomic<int>* nextBand, BandResult* result )
+ *@brief Claims bands of BAND_ROWS rows and accumulates the differences between the two images in them
+ *@param first The first image
+ *@param second The second image, the same size as first
+ *@param nextBand The shared index of the next unclaimed band
+ *@param result Where the totals for this thread are stored
+ *@return N/A
+ *@pre first and second are mapped and have the same dimensions
+ *@post result holds the totals over every band this thread claimed
+ */
+void compareBands ( const pim_image* first, const pim_image* second, atomic<int>* nextBand, BandResult* result )
+{
+    unsigned long long differing = 0, squaredError = 0;
+    int maxDifference = 0;
+    int band;
+
+    while ( ( band = nextBand->fetch_add ( 1 ) ) * BAND_ROWS < first->height )
+    {
+        int lastRow = ( band + 1 ) * BAND_ROWS;
+        if ( lastRow > first->height )
+            lastRow = first->height;
+
+        for ( int row = band * BAND_ROWS; row < lastRow; row++ )
+        {
+            const unsigned char* a = pim_row ( *first, row );
+            const unsigned char* b = pim_row ( *second, row );
+
+            //Accumulate per row so the inner loop has no branches and vectorizes
+            unsigned long long rowDiffering = 0, rowError = 0;
+            int rowMax = 0;
+            for ( size_t i = 0; i < first->rowBytes; i++ )
+            {
+                int difference = abs ( (int)a[i] - (int)b[i] );
+                rowDiffering += difference != 0;
+                rowError += difference * difference;
+                rowMax = difference > rowMax ? difference : rowMax;
+            }
+
+            differing += rowDiffering;
+            squaredError += rowError;
+            if ( rowMax > maxDifference )
+                maxDifference = rowMax;
+        }
+    }
+
+    result->differing = differing;
+    result->squaredError = squaredError;
+    result->maxDifference = maxDifference;
+}
@@ -1,47 +1,70 @@
 /** @file Dynamic.cpp
-  * @brief A dynamically assigned parallelized Mandelbrot calculator. The program assumes that thaere are less slaves than rows.
+  * @brief A dynamically assigned parallelized escape-time fractal calculator. Renders the Mandelbrot set unless another formula is picked with -f.
   * @author Tyler DeFoor
   * @date 3/4/2017
-  * @version 1.0
+  * @version 2.0
   */
- 
+
 #include "mpi.h"
-#include "PIMFuncs.h"
-#include "Mandelbrot.h"
+#include "Engine.h"
 #include <iostream>
 #include <stdlib.h>
 
-//#define WIDTH       20000
-//#define HEIGHT      20000
-#define ITERATIONS  256
-#define REAL_MIN    -2.0
-#define REAL_MAX    2.0
-#define IMAG_MIN    -2.0
-#define IMAG_MAX    2.0
-#define MASTER      0
-#define INT_TYPE    MPI_INT
-#define CHAR_TYPE   MPI_UNSIGNED_CHAR
-#define NUM_OBJECTS 1
-
 using namespace std;
 
+//Runs the slave side of the farm for whichever functor dispatchFractal picks
+struct Worker
+{
+    const View& view;
+    const RunOptions& run;
+    Trace& trace;
+
+    Worker ( const View& theView, const RunOptions& theRun, Trace& theTrace ) : view ( theView ), run ( theRun ), trace ( theTrace ) {}
+
+    template <class Formula>
+    void operator (  ) ( const Formula& formula )
+    {
+        farmWorker ( formula, view, run, trace );
+    }
+};
+
+//Renders everything on the master when there are no slaves
+struct Solo
+{
+    const View& view;
+    unsigned char** map;
+    Trace& trace;
+
+    Solo ( const View& theView, unsigned char** theMap, Trace& theTrace ) : view ( theView ), map ( theMap ), trace ( theTrace ) {}
+
+    template <class Formula>
+    void operator (  ) ( const Formula& formula )
+    {
+        double now = MPI_Wtime (  );
+        trace.stats.iterations = renderAll ( formula, view, map );
+        trace.stats.rows = view.height;
+        traceSpan ( trace, TRACE_COMPUTE, now, 0, MASTER );
+    }
+};
+
 int main ( int argc, char** argv )
 {
     /* Variable Declarations */
-    //Variables for the world size, current task id, the number of slaves, and number of rows calculated so far
-    int taskid, worldSize, numSlaves, rowsCalculated, currentRow;
+    //Variables for the world size, current task id and the number of slaves
+    int taskid, worldSize, numSlaves;
 
     //Timing variables
     double start, end, total;
 
-    int WIDTH = atoi(argv[1]);
-    int HEIGHT = atoi(argv[2]);
+    //The region being rendered and the formula
+    View view;
+    FractalOptions options;
 
-    //File name
-    const char* const fileName = "Dynamic.pim";
+    //File name, trace file and whether to print the summary
+    RunOptions run = { SCHEDULE_DYNAMIC, 1, "Dynamic.pim", NULL, false };
 
-    //Status variable to return with 
-    MPI_Status status;
+    //Per-rank counters and timeline
+    Trace trace;
 
     /* End of Variable Declarations */
 
@@ -57,149 +80,60 @@ int main ( int argc, char** argv )
     //Get Rank
     MPI_Comm_rank ( MPI_COMM_WORLD, &taskid );
 
+    //Every rank parses the same arguments so they agree on the view and formula
+    if ( !parseOptions ( argc, argv, view, options, run ) )
+    {
+        if ( taskid == MASTER )
+            printUsage ( argv[0] );
+        MPI_Finalize (  );
+        return 1;
+    }
+
+    //Line everyone up so the timelines share an epoch, spans are only kept if a trace file was asked for
+    traceStart ( trace, run.traceFile != NULL );
+
     //If we are in the master task
     if ( taskid == MASTER )
     {
-        rowsCalculated = 0;
-
         //Map for writing to file
-        unsigned char** map;
-        map = new unsigned char*[HEIGHT];
-        for ( int i = 0; i < HEIGHT; i++ )
-            map[i] = new unsigned char[WIDTH];
-
-        //Array to receive the calculated row
-        unsigned char* receiver = new unsigned char[WIDTH];
+        unsigned char** map = allocateMap ( view );
 
         start = MPI_Wtime (  );
 
-        //Send each slave a row
-        for ( int i = 0; i < numSlaves; i++ )
+        if ( numSlaves > 0 )
         {
-            MPI_Send ( &rowsCalculated, NUM_OBJECTS, INT_TYPE, (i + 1), 0, MPI_COMM_WORLD );
-            rowsCalculated++;
+            //The master only schedules, so it does not need to know the formula
+            farmMaster ( view, map, numSlaves, run, trace );
         }
-
-
-        //While there are still rows to calculate
-        while ( rowsCalculated < HEIGHT )
+        else
         {
-            //Receive a row
-            MPI_Recv ( receiver, WIDTH, CHAR_TYPE, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status );
-
-            //Put the row into the map
-            for ( int i = 0; i < WIDTH; i++ )
-            {
-                map[status.MPI_TAG][i] = receiver[i];
-            }
-
-            //Send the returning slave another row
-            MPI_Send ( &rowsCalculated, NUM_OBJECTS, INT_TYPE, status.MPI_SOURCE, 0, MPI_COMM_WORLD );
-
-            //Increase rowsCalculated
-            rowsCalculated++;
-        }
-
-        //Loop through all the slaves again
-        for ( int i = 0; i < numSlaves; i++ )
-        {
-            //Receive a row
-            MPI_Recv ( receiver, WIDTH, CHAR_TYPE, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status );
-
-            //Put the row into the map
-            for ( int i = 0; i < WIDTH; i++ )
-            {
-                map[status.MPI_TAG][i] = receiver[i];
-            }
-
-            int terminator = -1;
-            //Send the returning slave another row
-            MPI_Send ( &terminator, NUM_OBJECTS, INT_TYPE, status.MPI_SOURCE, 0, MPI_COMM_WORLD );
+            Solo solo ( view, map, trace );
+            dispatchFractal ( options, solo );
         }
 
         end = MPI_Wtime (  );
 
         total = end - start;
 
-        cout << "Total time for  " << WIDTH << " " << HEIGHT << ": " << total << endl;
-        pim_write_black_and_white(fileName, WIDTH, HEIGHT, (const unsigned char**)map);
+        cout << "Total time for  " << view.width << " " << view.height << ": " << total << endl;
+
+        if ( !writeImage ( run.fileName, view, map ) )
+            cerr << "Could not write " << run.fileName << endl;
+
+        freeMap ( map );
     }
 
     //If we are a slave
     else
     {
-        //Row that is being calculated
-        unsigned char* row = new unsigned char[WIDTH];
-
-        //Receive the first row
-        MPI_Recv ( &currentRow, 1, INT_TYPE, MASTER, 0, MPI_COMM_WORLD, &status );
-
-        //The master will send -1 when all rows are calculated
-        while ( currentRow != -1 )
-        {
-            //Loop through the row and calculate 
-            for ( int column = 0; column < WIDTH; column++ )
-            {
-                //Create the current complex number with the coordinates
-                Complex current;
-                current.real = REAL_MIN + column * (REAL_MAX - REAL_MIN) / WIDTH;
-                current.imag = IMAG_MIN + currentRow * (IMAG_MAX - IMAG_MIN) / HEIGHT;
-
-                //Set the map coordinate to the value of the Mandelbrot calculation
-                row[column] = calculate ( current );
-            }
-
-            //Send the row to master with the tag as the calculated row number
-            MPI_Send ( row, WIDTH, CHAR_TYPE, MASTER, currentRow, MPI_COMM_WORLD );
-
-            //Get the next row
-            MPI_Recv ( &currentRow, 1, INT_TYPE, MASTER, 0, MPI_COMM_WORLD, &status );
-        }
+        Worker worker ( view, run, trace );
+        dispatchFractal ( options, worker );
     }
-}
-
- /**Calculate
- *@fn calculate ( Complex coordinate )
- *@brief Determines whether a complex number is a member of the Mandelbrot set
- *@param coordinate The complex number to be tested
- *@return count The number of times the number was tested - maximum 256
- *@pre The parameter, coordinate, has relevant information
- *@post Nothing in coordinate is changed. 
- */
-unsigned char calculate ( Complex coordinate )
-{
-    //Keep track of the count 
-    int count = 0;
-
-    //A Complex number to hold Mandelbrot calculations
-    //Intially set to 0 + 0i
-    Complex current;
-    current.real = 0.0;
-    current.imag = 0.0;
-
-    //A temporary float holder and the length of the complex number squared
-    float temp, squarelength;
-
-    //Do this while squarelength < 4 and we are below the number of iterations
-    do
-    {
-        //The temp is currentreal ^ 2 - currentimag ^ 2 + coordinatereal
-        temp = current.real * current.real  - current.imag * current.imag + coordinate.real;
-
-        //Set currentimag to 2 * currentreal * currentimag + coordinageimag
-        current.imag = 2 * current.real * current.imag + coordinate.imag;
-
-        //Set currantreal to the previously calculated temp
-        current.real = temp;
-
-        //Get the square length of the imaginary number
-        squarelength = current.real * current.real + current.imag * current.imag;
-
-        //Increase count
-        count++;
 
-    } while ( ( squarelength < 4.0) && ( count < ITERATIONS ) );
+    //Gather the counters and timelines on the master
+    if ( run.summary || run.traceFile )
+        traceReport ( trace, taskid, worldSize, run.summary, run.traceFile );
 
-    //Return the number of iterations we went through
-    return (unsigned char)count;
+    MPI_Finalize (  );
+    return 0;
 }
@@ -0,0 +1,270 @@
+/** @file Engine.cpp
+  * @brief The parts of the escape-time fractal engine that do not depend on the formula: options, framebuffer, writers and the task farm master
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Engine.h"
+#include "PIMFuncs.h"
+#include "PIMTiles.h"
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//Julia constant used when -c is not given
+#define JULIA_REAL  -0.8f
+#define JULIA_IMAG  0.156f
+
+//Tile size and extension used when writing tiled output
+#define TILE_SIZE   256
+#define TILE_EXT    ".pimt"
+
+using namespace std;
+
+ /**parseOptions
+ *@fn bool parseOptions ( int argc, char** argv, View& view, FractalOptions& options, RunOptions& run )
+ *@brief Reads [-f fractal] [-p power] [-c real,imag] [-r realMin,realMax,imagMin,imagMax] [-i iterations] [-o file] [-s] [-t trace.json]
+ *                     [-m dynamic|static] [-k rows] WIDTH HEIGHT
+ *@param argc The argument count
+ *@param argv The arguments
+ *@param view Where the resolution, region and iterations are stored
+ *@param options Where the formula and its parameters are stored
+ *@param run Holds the default output file, which is replaced if -o is given, and where -s, -t, -m and -k are stored
+ *@return false if the arguments are not understood
+ *@pre N/A
+ *@post view and options are filled in with defaults for anything not given
+ */
+bool parseOptions ( int argc, char** argv, View& view, FractalOptions& options, RunOptions& run )
+{
+    int option;
+
+    //The defaults are the original Mandelbrot render
+    view.iterations = ITERATIONS;
+    view.realMin = REAL_MIN;
+    view.realMax = REAL_MAX;
+    view.imagMin = IMAG_MIN;
+    view.imagMax = IMAG_MAX;
+    options.kind = MANDELBROT;
+    options.power = 3;
+    options.cReal = JULIA_REAL;
+    options.cImag = JULIA_IMAG;
+    run.traceFile = NULL;
+    run.summary = false;
+    run.policy = SCHEDULE_DYNAMIC;
+    run.chunk = 1;
+
+    while ( ( option = getopt ( argc, argv, "f:p:c:r:i:o:st:m:k:" ) ) != -1 )
+    {
+        switch ( option )
+        {
+            case 'f':
+                if ( strcmp ( optarg, "mandelbrot" ) == 0 )
+                    options.kind = MANDELBROT;
+                else if ( strcmp ( optarg, "julia" ) == 0 )
+                    options.kind = JULIA;
+                else if ( strcmp ( optarg, "burningship" ) == 0 )
+                    options.kind = BURNING_SHIP;
+                else if ( strcmp ( optarg, "multibrot" ) == 0 )
+                    options.kind = MULTIBROT;
+                else
+                    return false;
+                break;
+            case 'p':
+                options.power = atoi ( optarg );
+                break;
+            case 'c':
+                if ( sscanf ( optarg, "%f,%f", &options.cReal, &options.cImag ) != 2 )
+                    return false;
+                break;
+            case 'r':
+                if ( sscanf ( optarg, "%lf,%lf,%lf,%lf", &view.realMin, &view.realMax, &view.imagMin, &view.imagMax ) != 4 )
+                    return false;
+                break;
+            case 'i':
+                view.iterations = atoi ( optarg );
+                break;
+            case 'o':
+                run.fileName = optarg;
+                break;
+            case 's':
+                run.summary = true;
+                break;
+            case 't':
+                run.traceFile = optarg;
+                break;
+            case 'm':
+                if ( strcmp ( optarg, "dynamic" ) == 0 )
+                    run.policy = SCHEDULE_DYNAMIC;
+                else if ( strcmp ( optarg, "static" ) == 0 )
+                    run.policy = SCHEDULE_STATIC;
+                else
+                    return false;
+                break;
+            case 'k':
+                run.chunk = atoi ( optarg );
+                break;
+            default:
+                return false;
+        }
+    }
+
+    //Only powers with an instantiated kernel are accepted
+    if ( options.kind == MULTIBROT && ( options.power < 2 || options.power > MAX_POWER ) )
+        return false;
+
+    //The width and height are the two positional arguments
+    if ( argc - optind != 2 )
+        return false;
+
+    view.width = atoi ( argv[optind] );
+    view.height = atoi ( argv[optind + 1] );
+
+    return view.width > 0 && view.height > 0 && view.iterations > 0 && run.chunk > 0;
+}
+
+ /**printUsage
+ *@fn void printUsage ( const char* program )
+ *@brief Prints the arguments parseOptions understands
+ *@param program The name the program was run as
+ *@return N/A
+ *@pre N/A
+ *@post The usage is on cerr
+ */
+void printUsage ( const char* program )
+{
+    cerr << "Usage: " << program << " [-f mandelbrot|julia|burningship|multibrot] [-p power] [-c real,imag]"
+         << " [-r realMin,realMax,imagMin,imagMax] [-i iterations] [-o file] [-s] [-t trace.json] [-m dynamic|static] [-k rows] WIDTH HEIGHT" << endl;
+}
+
+ /**allocateMap
+ *@fn unsigned char** allocateMap ( const View& view )
+ *@brief Allocates the framebuffer as one contiguous block with a pointer to each row
+ *@param view The resolution
+ *@return The row pointers, map[0] is the start of the block
+ *@pre N/A
+ *@post The map must be released with freeMap
+ */
+unsigned char** allocateMap ( const View& view )
+{
+    unsigned char** map = new unsigned char*[view.height];
+    map[0] = new unsigned char[(size_t)view.width * view.height];
+
+    for ( int i = 1; i < view.height; i++ )
+        map[i] = map[0] + (size_t)view.width * i;
+
+    return map;
+}
+
+ /**freeMap
+ *@fn void freeMap ( unsigned char** map )
+ *@brief Releases a framebuffer made by allocateMap
+ *@param map The framebuffer
+ *@return N/A
+ *@pre map was made by allocateMap
+ *@post map is released
+ */
+void freeMap ( unsigned char** map )
+{
+    delete [] map[0];
+    delete [] map;
+}
+
+ /**writeImage
+ *@fn bool writeImage ( const char* fileName, const View& view, unsigned char** map )
+ *@brief Writes the framebuffer as a flat P5 file, or as a compressed tiled file if the name ends in .pimt
+ *@param fileName The file to write
+ *@param view The resolution
+ *@param map The framebuffer
+ *@return false if the file could not be written
+ *@pre map was made by allocateMap and holds the image
+ *@post The image is on disk
+ */
+bool writeImage ( const char* fileName, const View& view, unsigned char** map )
+{
+    size_t length = strlen ( fileName );
+
+    //The map is contiguous, so the flat writer does not need to copy it
+    if ( length < strlen ( TILE_EXT ) || strcmp ( fileName + length - strlen ( TILE_EXT ), TILE_EXT ) != 0 )
+        return pim_write_black_and_white ( fileName, view.width, view.height, map[0] );
+
+    pim_tiles tiles;
+    bool ok = pim_tiles_create ( fileName, view.width, view.height, 1, TILE_SIZE, TILE_SIZE, true, tiles );
+
+    for ( int tileY = 0; ok && tileY < (int)tiles.header.tilesDown; tileY++ )
+        for ( int tileX = 0; ok && tileX < (int)tiles.header.tilesAcross; tileX++ )
+            ok = pim_tiles_write_tile ( tiles, tileX, tileY, map[tileY * TILE_SIZE] + tileX * TILE_SIZE, view.width );
+
+    pim_tiles_close ( tiles );
+    return ok;
+}
+
+ /**farmMaster
+ *@fn void farmMaster ( const View& view, unsigned char** map, int numSlaves, const RunOptions& run, Trace& trace )
+ *@brief The master side of the task farm. Collects chunks of run.chunk rows and, under SCHEDULE_DYNAMIC, hands the next chunk
+ *       to whichever slave returned one. This does not depend on the formula, the slaves run farmWorker for whatever functor was picked.
+ *@param view The resolution
+ *@param map The framebuffer the chunks are received into
+ *@param numSlaves The number of slaves, ranks 1 to numSlaves
+ *@param run The scheduling policy and chunk size
+ *@param trace Where every message the master sends or receives is timed
+ *@return N/A
+ *@pre Every slave is running farmWorker with the same view and run and traceStart has been called
+ *@post map holds the whole image and, under SCHEDULE_DYNAMIC, every slave has been sent TERMINATOR
+ */
+void farmMaster ( const View& view, unsigned char** map, int numSlaves, const RunOptions& run, Trace& trace )
+{
+    //The next row to hand out and the rows received so far
+    int rowsSent = 0, rowsReceived = 0, terminator = TERMINATOR, count;
+
+    //Status variable to return with
+    MPI_Status status;
+
+    //Send each slave a chunk, or stop it straight away if there are more slaves than chunks
+    double now = MPI_Wtime (  );
+    for ( int i = 1; run.policy == SCHEDULE_DYNAMIC && i <= numSlaves; i++ )
+    {
+        if ( rowsSent < view.height )
+        {
+            MPI_Send ( &rowsSent, NUM_OBJECTS, INT_TYPE, i, 0, MPI_COMM_WORLD );
+            now = traceSpan ( trace, TRACE_SEND, now, rowsSent, i );
+            rowsSent += run.chunk;
+        }
+        else
+        {
+            MPI_Send ( &terminator, NUM_OBJECTS, INT_TYPE, i, 0, MPI_COMM_WORLD );
+            now = traceSpan ( trace, TRACE_SEND, now, TERMINATOR, i );
+        }
+    }
+
+    //While there are still rows being calculated
+    while ( rowsReceived < view.height )
+    {
+        //Find out which chunk is coming and how big it is so it can be received straight into the map
+        MPI_Probe ( MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status );
+        MPI_Get_count ( &status, CHAR_TYPE, &count );
+        now = traceSpan ( trace, TRACE_RECV_WAIT, now, status.MPI_TAG, status.MPI_SOURCE );
+        MPI_Recv ( map[status.MPI_TAG], count, CHAR_TYPE, status.MPI_SOURCE, status.MPI_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        now = traceSpan ( trace, TRACE_RECV, now, status.MPI_TAG, status.MPI_SOURCE );
+        trace.stats.rows += count / view.width;
+        rowsReceived += count / view.width;
+
+        if ( run.policy == SCHEDULE_STATIC )
+            continue;
+
+        //Send the returning slave another chunk, or stop it if there are none left
+        if ( rowsSent < view.height )
+        {
+            MPI_Send ( &rowsSent, NUM_OBJECTS, INT_TYPE, status.MPI_SOURCE, 0, MPI_COMM_WORLD );
+            now = traceSpan ( trace, TRACE_SEND, now, rowsSent, status.MPI_SOURCE );
+            rowsSent += run.chunk;
+        }
+        else
+        {
+            MPI_Send ( &terminator, NUM_OBJECTS, INT_TYPE, status.MPI_SOURCE, 0, MPI_COMM_WORLD );
+            now = traceSpan ( trace, TRACE_SEND, now, TERMINATOR, status.MPI_SOURCE );
+        }
+    }
+}
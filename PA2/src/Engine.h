@@ -0,0 +1,150 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "mpi.h"
+#include "Fractal.h"
+#include "Trace.h"
+
+#define MASTER      0
+#define INT_TYPE    MPI_INT
+#define CHAR_TYPE   MPI_UNSIGNED_CHAR
+#define NUM_OBJECTS 1
+#define TERMINATOR  -1
+
+//How the master hands rows to the slaves
+enum SchedulePolicy
+{
+    //Slaves ask for the next chunk whenever they return one
+    SCHEDULE_DYNAMIC,
+
+    //Slave i takes chunks i - 1, i - 1 + numSlaves, ... without asking
+    SCHEDULE_STATIC
+};
+
+//What to do with the render besides computing it
+struct RunOptions
+{
+    //The scheduling policy and the number of rows per message
+    SchedulePolicy policy;
+    int chunk;
+
+    //The image file to write
+    const char* fileName;
+
+    //The Chrome trace file to write, or NULL
+    const char* traceFile;
+
+    //Whether to print the per-rank summary table
+    bool summary;
+};
+
+bool parseOptions ( int argc, char** argv, View& view, FractalOptions& options, RunOptions& run );
+void printUsage ( const char* program );
+unsigned char** allocateMap ( const View& view );
+void freeMap ( unsigned char** map );
+bool writeImage ( const char* fileName, const View& view, unsigned char** map );
+void farmMaster ( const View& view, unsigned char** map, int numSlaves, const RunOptions& run, Trace& trace );
+
+ /**renderAll
+ *@fn unsigned long long renderAll ( const Formula& formula, const View& view, unsigned char** map )
+ *@brief Renders every row of the view on this process
+ *@param formula The iteration functor
+ *@param view The region and resolution being rendered
+ *@param map The framebuffer, one pointer per row
+ *@return The total number of iterations executed
+ *@pre map was made by allocateMap for view
+ *@post map holds the whole image
+ */
+template <class Formula>
+unsigned long long renderAll ( const Formula& formula, const View& view, unsigned char** map )
+{
+    unsigned long long iterations = 0;
+
+    for ( int row = 0; row < view.height; row++ )
+        iterations += renderRow ( formula, view, row, map[row] );
+
+    return iterations;
+}
+
+ /**renderChunk
+ *@fn unsigned long long renderChunk ( const Formula& formula, const View& view, int firstRow, int rows, unsigned char* pixels )
+ *@brief Renders consecutive rows into one contiguous block
+ *@param formula The iteration functor
+ *@param view The region and resolution being rendered
+ *@param firstRow The first row of the chunk
+ *@param rows The number of rows in the chunk
+ *@param pixels The rows * view.width pixels of the chunk
+ *@return The total number of iterations executed
+ *@pre pixels holds at least rows * view.width bytes
+ *@post pixels holds the chunk
+ */
+template <class Formula>
+unsigned long long renderChunk ( const Formula& formula, const View& view, int firstRow, int rows, unsigned char* pixels )
+{
+    unsigned long long iterations = 0;
+
+    for ( int row = 0; row < rows; row++ )
+        iterations += renderRow ( formula, view, firstRow + row, pixels + (size_t)view.width * row );
+
+    return iterations;
+}
+
+ /**farmWorker
+ *@fn void farmWorker ( const Formula& formula, const View& view, const RunOptions& run, Trace& trace )
+ *@brief The slave side of the task farm. Renders chunks of run.chunk rows and sends each back tagged with its first row.
+ *       Under SCHEDULE_DYNAMIC the chunks are whatever the master sends until it sends TERMINATOR, under SCHEDULE_STATIC
+ *       they are every numSlaves-th chunk starting from this slave's.
+ *@param formula The iteration functor
+ *@param view The region and resolution being rendered
+ *@param run The scheduling policy and chunk size
+ *@param trace Where the time spent computing and waiting on the master is counted
+ *@return N/A
+ *@pre The master is running farmMaster with the same view and run and traceStart has been called
+ *@post Every chunk this slave was responsible for has been sent to the master
+ */
+template <class Formula>
+void farmWorker ( const Formula& formula, const View& view, const RunOptions& run, Trace& trace )
+{
+    //Chunk that is being calculated, its first row and its size
+    unsigned char* block = new unsigned char[(size_t)view.width * run.chunk];
+    int currentRow, rows, taskid, worldSize;
+
+    MPI_Comm_rank ( MPI_COMM_WORLD, &taskid );
+    MPI_Comm_size ( MPI_COMM_WORLD, &worldSize );
+
+    //Under the static policy the chunks are known up front, so the master is never asked
+    double now = MPI_Wtime (  );
+    if ( run.policy == SCHEDULE_STATIC )
+        currentRow = ( taskid - 1 ) * run.chunk;
+    else
+    {
+        MPI_Recv ( &currentRow, NUM_OBJECTS, INT_TYPE, MASTER, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+        now = traceSpan ( trace, TRACE_RECV_WAIT, now, currentRow, MASTER );
+    }
+
+    //The master will send TERMINATOR when all rows are calculated
+    while ( currentRow != TERMINATOR && currentRow < view.height )
+    {
+        rows = view.height - currentRow < run.chunk ? view.height - currentRow : run.chunk;
+        trace.stats.iterations += renderChunk ( formula, view, currentRow, rows, block );
+        trace.stats.rows += rows;
+        now = traceSpan ( trace, TRACE_COMPUTE, now, currentRow, MASTER );
+
+        //Send the chunk to master with the tag as its first row
+        MPI_Send ( block, view.width * rows, CHAR_TYPE, MASTER, currentRow, MPI_COMM_WORLD );
+        now = traceSpan ( trace, TRACE_SEND, now, currentRow, MASTER );
+
+        //Get the next chunk
+        if ( run.policy == SCHEDULE_STATIC )
+            currentRow += ( worldSize - 1 ) * run.chunk;
+        else
+        {
+            MPI_Recv ( &currentRow, NUM_OBJECTS, INT_TYPE, MASTER, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+            now = traceSpan ( trace, TRACE_RECV_WAIT, now, currentRow, MASTER );
+        }
+    }
+
+    delete [] block;
+}
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef FRACTAL_H
+#define FRACTAL_H
+
+#include <math.h>
+
+#define ITERATIONS  256
+#define REAL_MIN    -2.0
+#define REAL_MAX    2.0
+#define IMAG_MIN    -2.0
+#define IMAG_MAX    2.0
+
+//Highest Multibrot power dispatchFractal instantiates
+#define MAX_POWER   8
+
+//Pixels iterated together by renderRow, wide enough for one AVX register of floats
+#define LANES       8
+
+//The escape-time formulas the engine knows about
+enum FractalKind
+{
+    MANDELBROT,
+    JULIA,
+    BURNING_SHIP,
+    MULTIBROT
+};
+
+//Which formula to render and its parameters
+struct FractalOptions
+{
+    FractalKind kind;
+
+    //The power for Multibrot
+    int power;
+
+    //The constant for Julia
+    float cReal;
+    float cImag;
+};
+
+//The part of the complex plane being rendered and at what resolution
+struct View
+{
+    int width;
+    int height;
+    int iterations;
+    double realMin;
+    double realMax;
+    double imagMin;
+    double imagMax;
+};
+
+/* An iteration functor has two members:
+ *   start ( real, imag, zr, zi, kr, ki ) sets the starting z and the constant k for a pixel
+ *   step ( zr, zi, kr, ki, nr, ni ) computes the next z from z and k
+ * Both must be branch free so that renderRow vectorizes across its lanes. */
+
+//z = z^2 + c starting from 0
+struct Mandelbrot
+{
+    void start ( float real, float imag, float& zr, float& zi, float& kr, float& ki ) const
+    {
+        zr = 0.0f;
+        zi = 0.0f;
+        kr = real;
+        ki = imag;
+    }
+
+    void step ( float zr, float zi, float kr, float ki, float& nr, float& ni ) const
+    {
+        nr = zr * zr - zi * zi + kr;
+        ni = 2 * zr * zi + ki;
+    }
+};
+
+//z = z^2 + c for a fixed c starting from the pixel
+struct Julia
+{
+    float cReal;
+    float cImag;
+
+    Julia ( float real, float imag ) : cReal ( real ), cImag ( imag ) {}
+
+    void start ( float real, float imag, float& zr, float& zi, float& kr, float& ki ) const
+    {
+        zr = real;
+        zi = imag;
+        kr = cReal;
+        ki = cImag;
+    }
+
+    void step ( float zr, float zi, float kr, float ki, float& nr, float& ni ) const
+    {
+        nr = zr * zr - zi * zi + kr;
+        ni = 2 * zr * zi + ki;
+    }
+};
+
+//z = (|Re z| + i|Im z|)^2 + c starting from 0
+struct BurningShip
+{
+    void start ( float real, float imag, float& zr, float& zi, float& kr, float& ki ) const
+    {
+        zr = 0.0f;
+        zi = 0.0f;
+        kr = real;
+        ki = imag;
+    }
+
+    void step ( float zr, float zi, float kr, float ki, float& nr, float& ni ) const
+    {
+        float ar = fabsf ( zr );
+        float ai = fabsf ( zi );
+        nr = ar * ar - ai * ai + kr;
+        ni = 2 * ar * ai + ki;
+    }
+};
+
+//z = z^POWER + c starting from 0, the power is unrolled at compile time
+template <int POWER>
+struct Multibrot
+{
+    void start ( float real, float imag, float& zr, float& zi, float& kr, float& ki ) const
+    {
+        zr = 0.0f;
+        zi = 0.0f;
+        kr = real;
+        ki = imag;
+    }
+
+    void step ( float zr, float zi, float kr, float ki, float& nr, float& ni ) const
+    {
+        float pr = zr, pi = zi, temp;
+        for ( int i = 1; i < POWER; i++ )
+        {
+            temp = pr * zr - pi * zi;
+            pi = pr * zi + pi * zr;
+            pr = temp;
+        }
+        nr = pr + kr;
+        ni = pi + ki;
+    }
+};
+
+ /**renderRow
+ *@fn unsigned long long renderRow ( const Formula& formula, const View& view, int row, unsigned char* pixels )
+ *@brief Calculates the escape count of every pixel in a row, LANES pixels at a time. Lanes that escape stop changing
+ *       while the rest keep iterating, so the inner loop has no branches and the compiler vectorizes it per formula.
+ *@param formula The iteration functor
+ *@param view The region and resolution being rendered
+ *@param row The row to calculate
+ *@param pixels The view.width pixels of the row
+ *@return The total number of iterations executed for the row
+ *@pre pixels holds at least view.width bytes
+ *@post pixels holds the escape count of each pixel, modulo 256
+ */
+template <class Formula>
+inline unsigned long long renderRow ( const Formula& formula, const View& view, int row, unsigned char* pixels )
+{
+    unsigned long long total = 0;
+
+    //Coordinates are worked out in double and then narrowed, like the original calculate (  ) callers did
+    float imag = view.imagMin + row * (view.imagMax - view.imagMin) / view.height;
+
+    for ( int base = 0; base < view.width; base += LANES )
+    {
+        float zr[LANES], zi[LANES], kr[LANES], ki[LANES];
+        int count[LANES], alive[LANES];
+
+        for ( int lane = 0; lane < LANES; lane++ )
+        {
+            //Lanes past the end of the row repeat the last pixel and are never stored
+            int column = base + lane < view.width ? base + lane : view.width - 1;
+            float real = view.realMin + column * (view.realMax - view.realMin) / view.width;
+
+            formula.start ( real, imag, zr[lane], zi[lane], kr[lane], ki[lane] );
+            count[lane] = 0;
+            alive[lane] = 1;
+        }
+
+        //Every pixel gets at least one step, the same as the do while in the original calculate (  )
+        int anyAlive = 1;
+        for ( int iteration = 0; anyAlive && iteration < view.iterations; iteration++ )
+        {
+            anyAlive = 0;
+            for ( int lane = 0; lane < LANES; lane++ )
+            {
+                float nr, ni;
+                formula.step ( zr[lane], zi[lane], kr[lane], ki[lane], nr, ni );
+
+                int live = alive[lane];
+                zr[lane] = live ? nr : zr[lane];
+                zi[lane] = live ? ni : zi[lane];
+                count[lane] += live;
+                alive[lane] = live & ( nr * nr + ni * ni < 4.0f );
+                anyAlive |= alive[lane];
+            }
+        }
+
+        for ( int lane = 0; lane < LANES && base + lane < view.width; lane++ )
+        {
+            pixels[base + lane] = (unsigned char)count[lane];
+            total += count[lane];
+        }
+    }
+
+    return total;
+}
+
+ /**dispatchFractal
+ *@fn bool dispatchFractal ( const FractalOptions& options, Renderer& renderer )
+ *@brief Calls renderer with the iteration functor options asks for. This is the only place a formula is picked at run time,
+ *       everything the renderer does afterwards is instantiated for that one formula.
+ *@param options The formula and its parameters
+ *@param renderer An object with a templated operator (  ) taking the functor
+ *@return false if options does not name a formula the engine has
+ *@pre options came from parseOptions, which only accepts formulas this can dispatch
+ *@post renderer has been called once if true is returned
+ */
+template <class Renderer>
+bool dispatchFractal ( const FractalOptions& options, Renderer& renderer )
+{
+    switch ( options.kind )
+    {
+        case MANDELBROT:
+            renderer ( Mandelbrot (  ) );
+            return true;
+        case JULIA:
+            renderer ( Julia ( options.cReal, options.cImag ) );
+            return true;
+        case BURNING_SHIP:
+            renderer ( BurningShip (  ) );
+            return true;
+        case MULTIBROT:
+            switch ( options.power )
+            {
+                case 2: renderer ( Multibrot<2> (  ) ); return true;
+                case 3: renderer ( Multibrot<3> (  ) ); return true;
+                case 4: renderer ( Multibrot<4> (  ) ); return true;
+                case 5: renderer ( Multibrot<5> (  ) ); return true;
+                case 6: renderer ( Multibrot<6> (  ) ); return true;
+                case 7: renderer ( Multibrot<7> (  ) ); return true;
+                case 8: renderer ( Multibrot<8> (  ) ); return true;
+            }
+            return false;
+    }
+
+    return false;
+}
+
+#endif
@@ -1,5 +1,11 @@
 #include <cstdio>
 #include <cstring>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "PIMFuncs.h"
 
 #ifdef _WIN32
   #define WRITE_FLAGS "wb"
@@ -116,4 +122,92 @@ bool pim_write_color(const char * const fileName,
   ret = pim_write_color(fileName, width, height, t);
   delete [] t;
   return ret;
-}
\ No newline at end of file
+}
+/* Reads the next decimal field of a PNM header starting at *pos, skipping
+ * whitespace and '#' comments.  Returns -1 if the header is malformed. */
+static int pim_header_field(const unsigned char * data,
+                            const size_t length,
+                            size_t * pos)
+{
+  size_t p = *pos;
+  long value = 0;
+
+  while (p < length && (isspace(data[p]) || data[p] == '#'))
+  {
+    if (data[p] == '#')
+      while (p < length && data[p] != '\n') ++p;
+    else
+      ++p;
+  }
+  if (p >= length || !isdigit(data[p])) return -1;
+  while (p < length && isdigit(data[p]))
+  {
+    value = value * 10 + (data[p++] - '0');
+    if (value > 0x7fffffff) return -1;
+  }
+  *pos = p;
+  return (int)value;
+}
+bool pim_read(const char * const fileName, pim_image & image)
+{
+  struct stat info;
+  const unsigned char * data;
+  size_t pos = 2;
+  int maxValue, fd = open(fileName, O_RDONLY);
+
+  memset(&image, 0, sizeof(image));
+  if (fd < 0) return false;
+  if (fstat(fd, &info) != 0 || info.st_size < 3)
+  {
+    close(fd);
+    return false;
+  }
+  image.mapLength = (size_t)info.st_size;
+  image.map = mmap(NULL, image.mapLength, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (image.map == MAP_FAILED)
+  {
+    image.map = NULL;
+    return false;
+  }
+  madvise(image.map, image.mapLength, MADV_SEQUENTIAL);
+
+  data = (const unsigned char *)image.map;
+  if (data[0] != 'P' || (data[1] != '5' && data[1] != '6'))
+  {
+    pim_close(image);
+    return false;
+  }
+  image.channels = data[1] == '5' ? 1 : 3;
+  image.width = pim_header_field(data, image.mapLength, &pos);
+  image.height = pim_header_field(data, image.mapLength, &pos);
+  maxValue = pim_header_field(data, image.mapLength, &pos);
+
+  /* Only 8-bit rasters are supported, and a single whitespace byte
+   * separates the header from the raster. */
+  if (image.width <= 0 || image.height <= 0 || maxValue <= 0 ||
+      maxValue > 255 || pos >= image.mapLength || !isspace(data[pos]))
+  {
+    pim_close(image);
+    return false;
+  }
+  ++pos;
+  image.rowBytes = (size_t)image.width * image.channels;
+  if (image.mapLength - pos < image.rowBytes * image.height)
+  {
+    pim_close(image);
+    return false;
+  }
+  image.pixels = data + pos;
+
+  return true;
+}
+const unsigned char * pim_row(const pim_image & image, const int row)
+{
+  return image.pixels + image.rowBytes * row;
+}
+void pim_close(pim_image & image)
+{
+  if (image.map) munmap(image.map, image.mapLength);
+  memset(&image, 0, sizeof(image));
+}
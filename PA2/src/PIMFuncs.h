@@ -1,6 +1,22 @@
 #ifndef __PIMFUNCS_H__
 #define __PIMFUNCS_H__
 
+#include <cstddef>
+
+/* A P5 (grey) or P6 (color) image mapped read-only into memory.  pixels
+ * points at the first byte of the raster inside the mapping, so rows are
+ * views into the file and nothing is copied. */
+struct pim_image
+{
+  int width;
+  int height;
+  int channels;
+  size_t rowBytes;
+  const unsigned char * pixels;
+  void * map;
+  size_t mapLength;
+};
+
 bool pim_write_black_and_white(const char * const fileName,
                                const int width,
                                const int height,
@@ -30,4 +46,8 @@ bool pim_write_color(const char * const fileName,
                      const unsigned char ** green,
                      const unsigned char ** blue);
 
+bool pim_read(const char * const fileName, pim_image & image);
+const unsigned char * pim_row(const pim_image & image, const int row);
+void pim_close(pim_image & image);
+
 #endif
\ No newline at end of file
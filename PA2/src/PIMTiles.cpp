@@ -0,0 +1,362 @@
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "PIMTiles.h"
+
+/* Clipped size in pixels of tile (tileX, tileY). */
+static void pim_tile_size(const pim_tiles_header & header,
+                          const int tileX,
+                          const int tileY,
+                          int * width,
+                          int * height)
+{
+  *width = header.width - tileX * header.tileWidth;
+  *height = header.height - tileY * header.tileHeight;
+  if (*width > (int)header.tileWidth) *width = header.tileWidth;
+  if (*height > (int)header.tileHeight) *height = header.tileHeight;
+}
+/* PackBits style encoding: a control byte c < 128 is followed by c + 1
+ * literal bytes, c >= 128 by one byte repeated c - 126 times.  Returns the
+ * encoded length, or 0 if it would not fit in capacity. */
+static size_t pim_rle_encode(const unsigned char * in,
+                             const size_t length,
+                             unsigned char * out,
+                             const size_t capacity)
+{
+  size_t i = 0, o = 0, run, literal;
+
+  while (i < length)
+  {
+    run = 1;
+    while (i + run < length && run < 129 && in[i + run] == in[i]) ++run;
+    if (run >= 2)
+    {
+      if (o + 2 > capacity) return 0;
+      out[o++] = (unsigned char)(run + 126);
+      out[o++] = in[i];
+      i += run;
+      continue;
+    }
+    literal = 1;
+    while (i + literal < length && literal < 128 &&
+           !(i + literal + 1 < length && in[i + literal] == in[i + literal + 1]))
+      ++literal;
+    if (o + 1 + literal > capacity) return 0;
+    out[o++] = (unsigned char)(literal - 1);
+    memcpy(out + o, in + i, literal);
+    o += literal;
+    i += literal;
+  }
+
+  return o;
+}
+static bool pim_rle_decode(const unsigned char * in,
+                           const size_t length,
+                           unsigned char * out,
+                           const size_t expected)
+{
+  size_t i = 0, o = 0, count;
+
+  while (i < length)
+  {
+    if (in[i] < 128)
+    {
+      count = in[i] + 1;
+      if (i + 1 + count > length || o + count > expected) return false;
+      memcpy(out + o, in + i + 1, count);
+      i += 1 + count;
+    }
+    else
+    {
+      count = in[i] - 126;
+      if (i + 1 >= length || o + count > expected) return false;
+      memset(out + o, in[i + 1], count);
+      i += 2;
+    }
+    o += count;
+  }
+
+  return o == expected;
+}
+static bool pim_full_pwrite(const int fd,
+                            const void * buffer,
+                            size_t length,
+                            off_t offset)
+{
+  const char * p = (const char *)buffer;
+  ssize_t done;
+
+  while (length > 0)
+  {
+    done = pwrite(fd, p, length, offset);
+    if (done <= 0) return false;
+    p += done;
+    length -= done;
+    offset += done;
+  }
+  return true;
+}
+static bool pim_full_pread(const int fd,
+                           void * buffer,
+                           size_t length,
+                           off_t offset)
+{
+  char * p = (char *)buffer;
+  ssize_t done;
+
+  while (length > 0)
+  {
+    done = pread(fd, p, length, offset);
+    if (done <= 0) return false;
+    p += done;
+    length -= done;
+    offset += done;
+  }
+  return true;
+}
+bool pim_tiles_create(const char * const fileName,
+                      const int width,
+                      const int height,
+                      const int channels,
+                      const int tileWidth,
+                      const int tileHeight,
+                      const bool compress,
+                      pim_tiles & tiles)
+{
+  size_t numTiles, i;
+  pim_tiles_header & h = tiles.header;
+
+  memset(&tiles, 0, sizeof(tiles));
+  tiles.fd = -1;
+  if (width <= 0 || height <= 0 || tileWidth <= 0 || tileHeight <= 0 ||
+      (channels != 1 && channels != 3) ||
+      (uint64_t)tileWidth * tileHeight * channels > 0xffffffffu)
+    return false;
+
+  memcpy(h.magic, PIM_TILES_MAGIC, 4);
+  h.version = PIM_TILES_VERSION;
+  h.width = width;
+  h.height = height;
+  h.channels = channels;
+  h.tileWidth = tileWidth;
+  h.tileHeight = tileHeight;
+  h.tilesAcross = (width + tileWidth - 1) / tileWidth;
+  h.tilesDown = (height + tileHeight - 1) / tileHeight;
+  h.compress = compress ? 1 : 0;
+  h.slotBytes = (uint64_t)tileWidth * tileHeight * channels;
+  numTiles = (size_t)h.tilesAcross * h.tilesDown;
+  h.dataOffset = sizeof(pim_tiles_header) + numTiles * sizeof(pim_tile_entry);
+
+  tiles.index = new pim_tile_entry[numTiles];
+  for (i = 0; i < numTiles; ++i)
+  {
+    tiles.index[i].offset = h.dataOffset + i * h.slotBytes;
+    tiles.index[i].storedBytes = 0;
+    tiles.index[i].encoding = PIM_TILE_EMPTY;
+  }
+
+  tiles.fd = open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (tiles.fd < 0 ||
+      !pim_full_pwrite(tiles.fd, &h, sizeof(h), 0) ||
+      !pim_full_pwrite(tiles.fd, tiles.index, numTiles * sizeof(pim_tile_entry), sizeof(h)) ||
+      ftruncate(tiles.fd, h.dataOffset + numTiles * h.slotBytes) != 0)
+  {
+    pim_tiles_close(tiles);
+    return false;
+  }
+
+  return true;
+}
+bool pim_tiles_open(const char * const fileName,
+                    const bool writable,
+                    pim_tiles & tiles)
+{
+  size_t numTiles;
+  pim_tiles_header & h = tiles.header;
+
+  memset(&tiles, 0, sizeof(tiles));
+  tiles.fd = open(fileName, writable ? O_RDWR : O_RDONLY);
+  if (tiles.fd < 0) return false;
+
+  /* Everything the tile sizes and slot offsets are worked out from has to
+   * agree with what pim_tiles_create would have written, or a tile could be
+   * read or written past its buffer. */
+  if (!pim_full_pread(tiles.fd, &h, sizeof(h), 0) ||
+      memcmp(h.magic, PIM_TILES_MAGIC, 4) != 0 ||
+      h.version != PIM_TILES_VERSION ||
+      h.width == 0 || h.height == 0 || h.width > 0x7fffffffu || h.height > 0x7fffffffu ||
+      h.tileWidth == 0 || h.tileHeight == 0 ||
+      h.tileWidth > 0x7fffffffu || h.tileHeight > 0x7fffffffu ||
+      (h.channels != 1 && h.channels != 3) ||
+      (uint64_t)h.tileWidth * h.tileHeight * h.channels > 0xffffffffu ||
+      h.tilesAcross != ((uint64_t)h.width + h.tileWidth - 1) / h.tileWidth ||
+      h.tilesDown != ((uint64_t)h.height + h.tileHeight - 1) / h.tileHeight ||
+      h.slotBytes < (uint64_t)h.tileWidth * h.tileHeight * h.channels ||
+      h.dataOffset != sizeof(pim_tiles_header) +
+                      (uint64_t)h.tilesAcross * h.tilesDown * sizeof(pim_tile_entry))
+  {
+    pim_tiles_close(tiles);
+    return false;
+  }
+
+  numTiles = (size_t)h.tilesAcross * h.tilesDown;
+  tiles.index = new pim_tile_entry[numTiles];
+  if (!pim_full_pread(tiles.fd, tiles.index, numTiles * sizeof(pim_tile_entry), sizeof(h)))
+  {
+    pim_tiles_close(tiles);
+    return false;
+  }
+
+  return true;
+}
+bool pim_tiles_write_tile(pim_tiles & tiles,
+                          const int tileX,
+                          const int tileY,
+                          const unsigned char * pixels,
+                          const size_t stride)
+{
+  const pim_tiles_header & h = tiles.header;
+  int width, height, row;
+  size_t rowBytes, rawBytes, encoded = 0, tile;
+  unsigned char * raw, * rle = NULL;
+  pim_tile_entry entry;
+  bool ret;
+
+  if (tileX < 0 || tileY < 0 ||
+      tileX >= (int)h.tilesAcross || tileY >= (int)h.tilesDown)
+    return false;
+
+  pim_tile_size(h, tileX, tileY, &width, &height);
+  rowBytes = (size_t)width * h.channels;
+  rawBytes = rowBytes * height;
+  tile = (size_t)tileY * h.tilesAcross + tileX;
+
+  raw = new unsigned char[rawBytes];
+  for (row = 0; row < height; ++row)
+    memcpy(raw + rowBytes * row, pixels + stride * row, rowBytes);
+
+  if (h.compress)
+  {
+    rle = new unsigned char[rawBytes];
+    encoded = pim_rle_encode(raw, rawBytes, rle, rawBytes - 1);
+  }
+
+  entry.offset = h.dataOffset + tile * h.slotBytes;
+  entry.encoding = encoded ? PIM_TILE_RLE : PIM_TILE_RAW;
+  entry.storedBytes = encoded ? encoded : rawBytes;
+
+  /* The slot goes down before its index entry so a reader never sees an
+   * entry for data that is not there yet. */
+  ret = pim_full_pwrite(tiles.fd, encoded ? rle : raw, entry.storedBytes, entry.offset) &&
+        pim_full_pwrite(tiles.fd, &entry, sizeof(entry),
+                        sizeof(pim_tiles_header) + tile * sizeof(pim_tile_entry));
+  if (ret) tiles.index[tile] = entry;
+
+  delete [] raw;
+  delete [] rle;
+  return ret;
+}
+bool pim_tiles_read_tile(const pim_tiles & tiles,
+                         const int tileX,
+                         const int tileY,
+                         unsigned char * pixels,
+                         const size_t stride)
+{
+  const pim_tiles_header & h = tiles.header;
+  int width, height, row;
+  size_t rowBytes, rawBytes;
+  unsigned char * stored, * raw;
+  const pim_tile_entry * entry;
+  bool ret;
+
+  if (tileX < 0 || tileY < 0 ||
+      tileX >= (int)h.tilesAcross || tileY >= (int)h.tilesDown)
+    return false;
+
+  pim_tile_size(h, tileX, tileY, &width, &height);
+  rowBytes = (size_t)width * h.channels;
+  rawBytes = rowBytes * height;
+  entry = &tiles.index[(size_t)tileY * h.tilesAcross + tileX];
+
+  /* Tiles nobody wrote read back as black. */
+  if (entry->encoding == PIM_TILE_EMPTY)
+  {
+    for (row = 0; row < height; ++row) memset(pixels + stride * row, 0, rowBytes);
+    return true;
+  }
+  if ((entry->encoding != PIM_TILE_RAW && entry->encoding != PIM_TILE_RLE) ||
+      entry->storedBytes > h.slotBytes)
+    return false;
+
+  stored = new unsigned char[entry->storedBytes];
+  ret = pim_full_pread(tiles.fd, stored, entry->storedBytes, entry->offset);
+  raw = stored;
+  if (ret && entry->encoding == PIM_TILE_RLE)
+  {
+    raw = new unsigned char[rawBytes];
+    ret = pim_rle_decode(stored, entry->storedBytes, raw, rawBytes);
+  }
+  else if (entry->storedBytes != rawBytes)
+    ret = false;
+
+  if (ret)
+    for (row = 0; row < height; ++row)
+      memcpy(pixels + stride * row, raw + rowBytes * row, rowBytes);
+
+  if (raw != stored) delete [] raw;
+  delete [] stored;
+  return ret;
+}
+bool pim_tiles_read_region(const pim_tiles & tiles,
+                           const int x,
+                           const int y,
+                           const int width,
+                           const int height,
+                           unsigned char * pixels)
+{
+  const pim_tiles_header & h = tiles.header;
+  const size_t channels = h.channels;
+  const size_t tileStride = (size_t)h.tileWidth * channels;
+  int tileX, tileY, left, top, right, bottom, row;
+  unsigned char * tile;
+  bool ret = true;
+
+  if (x < 0 || y < 0 || width <= 0 || height <= 0 ||
+      x + width > (int)h.width || y + height > (int)h.height)
+    return false;
+
+  tile = new unsigned char[h.slotBytes];
+  for (tileY = y / h.tileHeight; ret && tileY <= (y + height - 1) / (int)h.tileHeight; ++tileY)
+  {
+    for (tileX = x / h.tileWidth; ret && tileX <= (x + width - 1) / (int)h.tileWidth; ++tileX)
+    {
+      ret = pim_tiles_read_tile(tiles, tileX, tileY, tile, tileStride);
+
+      /* Overlap of the tile and the region in image coordinates */
+      left = tileX * h.tileWidth;
+      top = tileY * h.tileHeight;
+      right = left + h.tileWidth;
+      bottom = top + h.tileHeight;
+      if (left < x) left = x;
+      if (top < y) top = y;
+      if (right > x + width) right = x + width;
+      if (bottom > y + height) bottom = y + height;
+
+      for (row = top; ret && row < bottom; ++row)
+        memcpy(pixels + ((size_t)(row - y) * width + (left - x)) * channels,
+               tile + (row - tileY * h.tileHeight) * tileStride +
+                      (left - tileX * h.tileWidth) * channels,
+               (right - left) * channels);
+    }
+  }
+
+  delete [] tile;
+  return ret;
+}
+void pim_tiles_close(pim_tiles & tiles)
+{
+  if (tiles.fd >= 0) close(tiles.fd);
+  delete [] tiles.index;
+  memset(&tiles, 0, sizeof(tiles));
+  tiles.fd = -1;
+}
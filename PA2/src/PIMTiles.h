@@ -0,0 +1,87 @@
+#ifndef __PIMTILES_H__
+#define __PIMTILES_H__
+
+#include <stdint.h>
+#include <cstddef>
+
+/* A tiled image container for renders too big to handle as one flat P5/P6
+ * file.  The file is a fixed header, an index with one entry per tile and
+ * one slot per tile, all at offsets known from the dimensions alone:
+ *
+ *   pim_tiles_header | pim_tile_entry[tilesAcross * tilesDown] | slots
+ *
+ * Tile (x, y) lives in slot y * tilesAcross + x, which is slotBytes long.
+ * Because nothing depends on what other tiles hold, any process can write
+ * any tile with pwrite once the file has been created, and a reader can
+ * fetch one region by reading only the index entries and slots it needs.
+ * Tiles on the right and bottom edges are clipped to the image.  With
+ * compression on, a tile is stored run-length encoded when that is smaller,
+ * leaving the rest of its slot as a hole in the (sparse) file.  Integers are
+ * stored in host byte order. */
+
+#define PIM_TILES_MAGIC    "PIMT"
+#define PIM_TILES_VERSION  1
+#define PIM_TILE_EMPTY     0
+#define PIM_TILE_RAW       1
+#define PIM_TILE_RLE       2
+
+struct pim_tiles_header
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t channels;
+  uint32_t tileWidth;
+  uint32_t tileHeight;
+  uint32_t tilesAcross;
+  uint32_t tilesDown;
+  uint32_t compress;
+  uint64_t slotBytes;
+  uint64_t dataOffset;
+};
+
+struct pim_tile_entry
+{
+  uint64_t offset;
+  uint32_t storedBytes;
+  uint32_t encoding;
+};
+
+struct pim_tiles
+{
+  int fd;
+  pim_tiles_header header;
+  pim_tile_entry * index;
+};
+
+bool pim_tiles_create(const char * const fileName,
+                      const int width,
+                      const int height,
+                      const int channels,
+                      const int tileWidth,
+                      const int tileHeight,
+                      const bool compress,
+                      pim_tiles & tiles);
+bool pim_tiles_open(const char * const fileName,
+                    const bool writable,
+                    pim_tiles & tiles);
+bool pim_tiles_write_tile(pim_tiles & tiles,
+                          const int tileX,
+                          const int tileY,
+                          const unsigned char * pixels,
+                          const size_t stride);
+bool pim_tiles_read_tile(const pim_tiles & tiles,
+                         const int tileX,
+                         const int tileY,
+                         unsigned char * pixels,
+                         const size_t stride);
+bool pim_tiles_read_region(const pim_tiles & tiles,
+                           const int x,
+                           const int y,
+                           const int width,
+                           const int height,
+                           unsigned char * pixels);
+void pim_tiles_close(pim_tiles & tiles);
+
+#endif
@@ -1,118 +1,75 @@
 /** @file Sequential.cpp
-  * @brief A sequential program for generating the Mandelbrot set
+  * @brief A sequential program for generating escape-time fractals. Renders the Mandelbrot set unless another formula is picked with -f.
   * @author Tyler DeFoor
   * @date 3/2/2017
-  * @version 1.0
+  * @version 2.0
   */
 
 #include "mpi.h"
-#include "PIMFuncs.h"
-#include "Mandelbrot.h"
+#include "Engine.h"
 #include <iostream>
 #include <stdlib.h>
 
-//#define WIDTH       35000
-//#define HEIGHT      35000
-#define ITERATIONS  256
-#define REAL_MIN    -2.0
-#define REAL_MAX    2.0
-#define IMAG_MIN    -2.0
-#define IMAG_MAX    2.0
-
 using namespace std;
 
+//Renders every row for whichever functor dispatchFractal picks
+struct Renderer
+{
+    const View& view;
+    unsigned char** map;
+
+    Renderer ( const View& theView, unsigned char** theMap ) : view ( theView ), map ( theMap ) {}
+
+    template <class Formula>
+    void operator (  ) ( const Formula& formula )
+    {
+        renderAll ( formula, view, map );
+    }
+};
+
 int main ( int argc, char** argv )
 {
     /* Variable Declarations */
     //Timing variables
     double start, end, total;
 
-    int WIDTH = atoi(argv[1]);
-    int HEIGHT = atoi(argv[2]);
+    //The region being rendered and the formula
+    View view;
+    FractalOptions options;
 
-    //File name
-    const char* const fileName = "Sequential.pim";
-
-    //Map for writing to file
-    unsigned char** map;
-    map = new unsigned char*[HEIGHT];
-    for ( int i = 0; i < HEIGHT; i++ )
-        map[i] = new unsigned char[WIDTH];
+    //File name, the farm options are accepted but there is no farm to schedule or trace
+    RunOptions run = { SCHEDULE_DYNAMIC, 1, "Sequential.pim", NULL, false };
 
     /* End of Variable Declarations */
 
     MPI_Init ( &argc, &argv );
 
-    start = MPI_Wtime (  );
-
-    //Iterate rows from 0 to HEIGHT - 1
-    for ( int row = 0; row < HEIGHT; row++ )
+    if ( !parseOptions ( argc, argv, view, options, run ) )
     {
-        //Iterate columns from 0 to WIDTH - 1
-        for ( int column = 0; column < WIDTH; column++ )
-        {
-            //Create the current complex number with the coordinates
-            Complex current;
-            current.real = REAL_MIN + column * (REAL_MAX - REAL_MIN) / WIDTH;
-            current.imag = IMAG_MIN + row * (IMAG_MAX - IMAG_MIN) / HEIGHT;
-
-            //Set the map coordinate to the value of the Mandelbrot calculation
-            map[row][column] = calculate ( current );
-        }
+        printUsage ( argv[0] );
+        MPI_Finalize (  );
+        return 1;
     }
 
-    end = MPI_Wtime (  );
-
-    total = end - start;
-
-    cout << "Total time: " << total << endl;
-
-    pim_write_black_and_white(fileName, WIDTH, HEIGHT, (const unsigned char**)map);
-    return 0;
-}
-
- /**Calculate
- *@fn calculate ( Complex coordinate )
- *@brief Determines whether a complex number is a member of the Mandelbrot set
- *@param coordinate The complex number to be tested
- *@return count The number of times the number was tested - maximum 256
- *@pre The parameter, coordinate, has relevant information
- *@post Nothing in coordinate is changed. 
- */
-unsigned char calculate ( Complex coordinate )
-{
-    //Keep track of the count 
-    int count = 0;
-
-    //A Complex number to hold Mandelbrot calculations
-    //Intially set to 0 + 0i
-    Complex current;
-    current.real = 0.0;
-    current.imag = 0.0;
+    //Map for writing to file
+    unsigned char** map = allocateMap ( view );
+    Renderer renderer ( view, map );
 
-    //A temporary float holder and the length of the complex number squared
-    float temp, squarelength;
+    start = MPI_Wtime (  );
 
-    //Do this while squarelength < 4 and we are below the number of iterations
-    do
-    {
-        //The temp is currentreal ^ 2 - currentimag ^ 2 + coordinatereal
-        temp = current.real * current.real  - current.imag * current.imag + coordinate.real;
+    dispatchFractal ( options, renderer );
 
-        //Set currentimag to 2 * currentreal * currentimag + coordinageimag
-        current.imag = 2 * current.real * current.imag + coordinate.imag;
+    end = MPI_Wtime (  );
 
-        //Set currantreal to the previously calculated temp
-        current.real = temp;
+    total = end - start;
 
-        //Get the square length of the imaginary number
-        squarelength = current.real * current.real + current.imag * current.imag;
+    cout << "Total time: " << total << endl;
 
-        //Increase count
-        count++;
+    if ( !writeImage ( run.fileName, view, map ) )
+        cerr << "Could not write " << run.fileName << endl;
 
-    } while ( ( squarelength < 4.0) && ( count < ITERATIONS ) );
+    freeMap ( map );
 
-    //Return the number of iterations we went through
-    return (unsigned char)count;
+    MPI_Finalize (  );
+    return 0;
 }
@@ -0,0 +1,177 @@
+/** @file TileConvert.cpp
+  * @brief Converts between flat P5/P6 renders and the tiled PIMTiles container, and extracts single regions from a tiled file.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "PIMFuncs.h"
+#include "PIMTiles.h"
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_TILE    256
+
+using namespace std;
+
+int toTiles ( const char* input, const char* output, int tileSize, bool compress );
+int toFlat ( const char* input, const char* output );
+int extractRegion ( const char* input, const char* output, int x, int y, int width, int height );
+void usage ( const char* program );
+
+int main ( int argc, char** argv )
+{
+    if ( argc >= 4 && strcmp ( argv[1], "totiles" ) == 0 )
+    {
+        //Optional tile size and compression flag
+        int tileSize = argc > 4 ? atoi ( argv[4] ) : DEFAULT_TILE;
+        bool compress = argc > 5 && strcmp ( argv[5], "rle" ) == 0;
+
+        return toTiles ( argv[2], argv[3], tileSize, compress );
+    }
+
+    if ( argc == 4 && strcmp ( argv[1], "toflat" ) == 0 )
+        return toFlat ( argv[2], argv[3] );
+
+    if ( argc == 8 && strcmp ( argv[1], "region" ) == 0 )
+        return extractRegion ( argv[2], argv[3], atoi ( argv[4] ), atoi ( argv[5] ), atoi ( argv[6] ), atoi ( argv[7] ) );
+
+    usage ( argv[0] );
+    return 1;
+}
+
+ /**toTiles
+ *@fn int toTiles ( const char* input, const char* output, int tileSize, bool compress )
+ *@brief Writes a flat P5/P6 image out as a tiled file with square tiles
+ *@param input The flat image
+ *@param output The tiled file to create
+ *@param tileSize The width and height of a tile
+ *@param compress Whether tiles may be run-length encoded
+ *@return 0 on success, 1 on failure
+ *@pre N/A
+ *@post output holds every tile of input
+ */
+int toTiles ( const char* input, const char* output, int tileSize, bool compress )
+{
+    pim_image image;
+    pim_tiles tiles;
+
+    if ( !pim_read ( input, image ) )
+    {
+        cerr << "Could not read " << input << endl;
+        return 1;
+    }
+
+    if ( !pim_tiles_create ( output, image.width, image.height, image.channels, tileSize, tileSize, compress, tiles ) )
+    {
+        cerr << "Could not create " << output << endl;
+        pim_close ( image );
+        return 1;
+    }
+
+    //Tiles come straight out of the mapping, the stride is the image row
+    bool ok = true;
+    for ( int tileY = 0; ok && tileY < (int)tiles.header.tilesDown; tileY++ )
+    {
+        for ( int tileX = 0; ok && tileX < (int)tiles.header.tilesAcross; tileX++ )
+        {
+            const unsigned char* corner = pim_row ( image, tileY * tileSize ) + (size_t)tileX * tileSize * image.channels;
+            ok = pim_tiles_write_tile ( tiles, tileX, tileY, corner, image.rowBytes );
+        }
+    }
+
+    pim_tiles_close ( tiles );
+    pim_close ( image );
+
+    if ( !ok )
+        cerr << "Could not write the tiles of " << output << endl;
+
+    return ok ? 0 : 1;
+}
+
+ /**toFlat
+ *@fn int toFlat ( const char* input, const char* output )
+ *@brief Reassembles a tiled file into a flat P5/P6 image
+ *@param input The tiled file
+ *@param output The flat image to write
+ *@return 0 on success, 1 on failure
+ *@pre N/A
+ *@post output holds the whole image
+ */
+int toFlat ( const char* input, const char* output )
+{
+    pim_tiles tiles;
+
+    if ( !pim_tiles_open ( input, false, tiles ) )
+    {
+        cerr << "Could not read " << input << endl;
+        return 1;
+    }
+
+    int width = tiles.header.width;
+    int height = tiles.header.height;
+    int ret = extractRegion ( input, output, 0, 0, width, height );
+
+    pim_tiles_close ( tiles );
+    return ret;
+}
+
+ /**extractRegion
+ *@fn int extractRegion ( const char* input, const char* output, int x, int y, int width, int height )
+ *@brief Reads one region of a tiled file, touching only the tiles that overlap it, and writes it as a flat image
+ *@param input The tiled file
+ *@param output The flat image to write
+ *@param x The left column of the region
+ *@param y The top row of the region
+ *@param width The width of the region
+ *@param height The height of the region
+ *@return 0 on success, 1 on failure
+ *@pre N/A
+ *@post output holds the region
+ */
+int extractRegion ( const char* input, const char* output, int x, int y, int width, int height )
+{
+    pim_tiles tiles;
+    bool ok;
+
+    if ( !pim_tiles_open ( input, false, tiles ) )
+    {
+        cerr << "Could not read " << input << endl;
+        return 1;
+    }
+
+    unsigned char* pixels = new unsigned char[(size_t)width * height * tiles.header.channels];
+
+    ok = pim_tiles_read_region ( tiles, x, y, width, height, pixels );
+    if ( ok )
+    {
+        if ( tiles.header.channels == 1 )
+            ok = pim_write_black_and_white ( output, width, height, pixels );
+        else
+            ok = pim_write_color ( output, width, height, pixels );
+    }
+
+    if ( !ok )
+        cerr << "Could not copy the region out of " << input << endl;
+
+    delete [] pixels;
+    pim_tiles_close ( tiles );
+
+    return ok ? 0 : 1;
+}
+
+ /**usage
+ *@fn void usage ( const char* program )
+ *@brief Prints how to run the converter
+ *@param program The name the program was run as
+ *@return N/A
+ *@pre N/A
+ *@post The usage is on cerr
+ */
+void usage ( const char* program )
+{
+    cerr << "Usage: " << program << " totiles in.pim out.pimt [tileSize] [rle]" << endl;
+    cerr << "       " << program << " toflat in.pimt out.pim" << endl;
+    cerr << "       " << program << " region in.pimt out.pim x y width height" << endl;
+}
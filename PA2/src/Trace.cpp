@@ -0,0 +1,150 @@
+/** @file Trace.cpp
+  * @brief Collects the per-rank counters and timelines of the task farm on the master and reports them as a table and a Chrome trace
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Trace.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string.h>
+#include <string>
+
+#define MASTER      0
+#define MICROS      1e6
+
+using namespace std;
+
+//Names of the span kinds as they appear in the trace viewer
+static const char* const KIND_NAMES[] = { "compute", "send", "recv wait", "recv" };
+
+ /**traceStart
+ *@fn void traceStart ( Trace& trace, bool keepEvents )
+ *@brief Clears the counters and lines every rank up on a shared epoch. This is collective.
+ *@param trace This rank's trace
+ *@param keepEvents Whether every span is kept for a trace file, or only the totals
+ *@return N/A
+ *@pre MPI is initialized
+ *@post Times in trace are relative to an epoch taken just after a barrier
+ */
+void traceStart ( Trace& trace, bool keepEvents )
+{
+    memset ( &trace.stats, 0, sizeof ( trace.stats ) );
+    trace.events.clear (  );
+    trace.keepEvents = keepEvents;
+
+    MPI_Barrier ( MPI_COMM_WORLD );
+    trace.epoch = MPI_Wtime (  );
+}
+
+ /**traceReport
+ *@fn void traceReport ( Trace& trace, int taskid, int worldSize, bool summary, const char* traceFile )
+ *@brief Gathers every rank's totals and spans to the master, which prints the summary table and writes the trace file. This is collective.
+ *@param trace This rank's trace
+ *@param taskid This rank
+ *@param worldSize The number of ranks
+ *@param summary Whether the master prints the per-rank table
+ *@param traceFile The Chrome trace-event JSON file to write, or NULL
+ *@return N/A
+ *@pre Every rank called traceStart and has finished the farm
+ *@post The table is on cout and the trace file is written if they were asked for
+ */
+void traceReport ( Trace& trace, int taskid, int worldSize, bool summary, const char* traceFile )
+{
+    vector<TraceStats> stats ( taskid == MASTER ? worldSize : 0 );
+
+    MPI_Gather ( &trace.stats, STATS_FIELDS, MPI_DOUBLE, stats.data (  ), STATS_FIELDS, MPI_DOUBLE, MASTER, MPI_COMM_WORLD );
+
+    //Gather the spans as bytes, with each rank's count first
+    vector<TraceEvent> events;
+    vector<int> counts ( worldSize ), displacements ( worldSize );
+    int myBytes = trace.events.size (  ) * sizeof ( TraceEvent );
+
+    if ( traceFile )
+    {
+        MPI_Gather ( &myBytes, 1, MPI_INT, counts.data (  ), 1, MPI_INT, MASTER, MPI_COMM_WORLD );
+
+        int totalBytes = 0;
+        for ( int i = 0; taskid == MASTER && i < worldSize; i++ )
+        {
+            displacements[i] = totalBytes;
+            totalBytes += counts[i];
+        }
+        events.resize ( totalBytes / sizeof ( TraceEvent ) );
+
+        MPI_Gatherv ( trace.events.data (  ), myBytes, MPI_BYTE, events.data (  ), counts.data (  ), displacements.data (  ),
+                      MPI_BYTE, MASTER, MPI_COMM_WORLD );
+    }
+
+    if ( taskid != MASTER )
+        return;
+
+    if ( summary )
+    {
+        double computeTotal = 0, computeMax = 0;
+
+        cout << setw ( 6 ) << "rank" << setw ( 10 ) << "rows" << setw ( 16 ) << "iterations" << setw ( 12 ) << "compute"
+             << setw ( 12 ) << "send wait" << setw ( 12 ) << "recv wait" << setw ( 12 ) << "recv" << endl;
+
+        for ( int i = 0; i < worldSize; i++ )
+        {
+            cout << setw ( 6 ) << i << setw ( 10 ) << (long long)stats[i].rows << setw ( 16 ) << (long long)stats[i].iterations
+                 << fixed << setprecision ( 6 ) << setw ( 12 ) << stats[i].compute << setw ( 12 ) << stats[i].sendWait
+                 << setw ( 12 ) << stats[i].recvWait << setw ( 12 ) << stats[i].recv << endl;
+            cout.unsetf ( ios::floatfield );
+
+            if ( i != MASTER )
+            {
+                computeTotal += stats[i].compute;
+                if ( stats[i].compute > computeMax )
+                    computeMax = stats[i].compute;
+            }
+        }
+
+        //Max over mean compute of the slaves, 1 is perfectly balanced
+        if ( worldSize > 1 && computeTotal > 0 )
+            cout << "Compute imbalance (max/mean): " << computeMax / ( computeTotal / ( worldSize - 1 ) ) << endl;
+
+        //How much of its time the master spent waiting for rows rather than handling them
+        double masterBusy = stats[MASTER].recv + stats[MASTER].sendWait;
+        if ( masterBusy + stats[MASTER].recvWait > 0 )
+            cout << "Master idle fraction: " << stats[MASTER].recvWait / ( masterBusy + stats[MASTER].recvWait ) << endl;
+    }
+
+    if ( traceFile )
+    {
+        ofstream fout ( traceFile );
+
+        if ( !fout )
+        {
+            cerr << "Could not write " << traceFile << endl;
+            return;
+        }
+
+        fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+
+        //Name each rank's track
+        for ( int i = 0; i < worldSize; i++ )
+            fout << ( i == 0 ? "" : ",\n" ) << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i
+                 << ",\"args\":{\"name\":\"" << ( i == MASTER ? "master" : "slave " + to_string ( i ) ) << "\"}}";
+
+        //Spans are grouped by rank in gather order, so the rank comes from the displacements
+        int rank = 0;
+        fout << fixed << setprecision ( 3 );
+        for ( size_t e = 0; e < events.size (  ); e++ )
+        {
+            while ( rank + 1 < worldSize && e * sizeof ( TraceEvent ) >= (size_t)displacements[rank + 1] )
+                rank++;
+
+            const TraceEvent& event = events[e];
+            fout << ",\n{\"name\":\"" << KIND_NAMES[event.kind] << "\",\"cat\":\"farm\",\"ph\":\"X\",\"pid\":0,\"tid\":" << rank
+                 << ",\"ts\":" << event.start * MICROS << ",\"dur\":" << ( event.end - event.start ) * MICROS
+                 << ",\"args\":{\"row\":" << event.row << ",\"peer\":" << event.peer << "}}";
+        }
+
+        fout << endl;
+        fout << "]}" << endl;
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "mpi.h"
+#include <vector>
+
+//What a span on the timeline was spent doing
+enum TraceKind
+{
+    TRACE_COMPUTE,
+    TRACE_SEND,
+    TRACE_RECV_WAIT,
+    TRACE_RECV
+};
+
+//Totals one rank keeps about itself, all doubles so they gather as one MPI_DOUBLE block
+struct TraceStats
+{
+    double rows;
+    double iterations;
+    double compute;
+    double sendWait;
+    double recvWait;
+    double recv;
+};
+
+#define STATS_FIELDS    6
+
+//One span on a rank's timeline, times are seconds since the shared epoch
+struct TraceEvent
+{
+    double start;
+    double end;
+    int kind;
+    int row;
+    int peer;
+    int pad;
+};
+
+//Counters and, when enabled, every span of one rank
+struct Trace
+{
+    bool keepEvents;
+    double epoch;
+    TraceStats stats;
+    std::vector<TraceEvent> events;
+};
+
+void traceStart ( Trace& trace, bool keepEvents );
+void traceReport ( Trace& trace, int taskid, int worldSize, bool summary, const char* traceFile );
+
+ /**traceSpan
+ *@fn double traceSpan ( Trace& trace, TraceKind kind, double start, int row, int peer )
+ *@brief Ends a span that began at start, adds it to the totals for its kind and keeps it if events are kept
+ *@param trace This rank's trace
+ *@param kind What the span was spent doing
+ *@param start MPI_Wtime (  ) when the span began
+ *@param row The row the span was about
+ *@param peer The rank on the other end of a message, or this rank
+ *@return MPI_Wtime (  ) now, so the next span can start from it
+ *@pre traceStart has been called
+ *@post The span is counted
+ */
+inline double traceSpan ( Trace& trace, TraceKind kind, double start, int row, int peer )
+{
+    double now = MPI_Wtime (  );
+
+    switch ( kind )
+    {
+        case TRACE_COMPUTE:   trace.stats.compute += now - start;  break;
+        case TRACE_SEND:      trace.stats.sendWait += now - start; break;
+        case TRACE_RECV_WAIT: trace.stats.recvWait += now - start; break;
+        case TRACE_RECV:      trace.stats.recv += now - start;     break;
+    }
+
+    if ( trace.keepEvents )
+    {
+        TraceEvent event = { start - trace.epoch, now - trace.epoch, kind, row, peer, 0 };
+        trace.events.push_back ( event );
+    }
+
+    return now;
+}
+
+#endif
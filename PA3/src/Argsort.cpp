@@ -0,0 +1,93 @@
+/** @file Argsort.cpp
+  * @brief Sorting row numbers by key. Several key columns are packed into one unsigned 64 bit key, the first column in
+  *        the highest bits, so the key's order is the columns' order compared one after another and radix sort
+  *        handles every column in the same passes, skipping the digits no column uses.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Argsort.h"
+#include "Random.h"
+#include <stdlib.h>
+
+using namespace std;
+
+ /**parseColumnBits
+ *@fn bool parseColumnBits ( const char* list, vector<int>& widths )
+ *@brief Reads a comma separated list of column widths in bits, such as 8,16,8
+ *@param list The list
+ *@param widths Where the widths are stored
+ *@return false if a width is not from 1 to 32 or they add up to more than 64
+ *@pre N/A
+ *@post widths holds the list if true is returned
+ */
+bool parseColumnBits ( const char* list, vector<int>& widths )
+{
+    int total = 0;
+    widths.clear (  );
+
+    while ( *list )
+    {
+        char* end;
+        long width = strtol ( list, &end, 10 );
+
+        if ( end == list || width < 1 || width > 32 || ( *end != ',' && *end != '\0' ) )
+            return false;
+
+        total += width;
+        widths.push_back ( width );
+        list = *end == ',' ? end + 1 : end;
+    }
+
+    return !widths.empty (  ) && total <= 64;
+}
+
+ /**packColumns
+ *@fn unsigned long long packColumns ( const unsigned int* columns, const vector<int>& widths )
+ *@brief Packs one row's columns into a key, each column in its width of bits below the one before it
+ *@param columns The row's columns
+ *@param widths The width of each column
+ *@return The packed key
+ *@pre columns holds a value for each width and each value fits in its width
+ *@post N/A
+ */
+unsigned long long packColumns ( const unsigned int* columns, const vector<int>& widths )
+{
+    unsigned long long key = 0;
+
+    for ( size_t c = 0; c < widths.size (  ); c++ )
+        key = ( key << widths[c] ) | columns[c];
+
+    return key;
+}
+
+ /**makeColumns
+ *@fn void makeColumns ( unsigned long long* keys, long long first, size_t n, const vector<int>& widths, unsigned long long seed )
+ *@brief Makes up rows first to first + n - 1 of uniform columns and packs each row into a key. Column c comes from
+ *       the seed plus c, so the columns are independent and the same rows get the same columns for any number of ranks.
+ *@param keys Where the packed keys are stored
+ *@param first The row number of the first row
+ *@param n The number of rows
+ *@param widths The width of each column
+ *@param seed The seed
+ *@return N/A
+ *@pre keys holds n keys and widths came from parseColumnBits
+ *@post keys holds the packed rows
+ */
+void makeColumns ( unsigned long long* keys, long long first, size_t n, const vector<int>& widths, unsigned long long seed )
+{
+    unsigned int columns[MAX_COLUMNS];
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        for ( size_t c = 0; c < widths.size (  ); c++ )
+        {
+            unsigned int bits[4];
+            philox ( first + i, seed + c, bits );
+            columns[c] = bits[0] >> ( 32 - widths[c] );
+        }
+
+        keys[i] = packColumns ( columns, widths );
+    }
+}
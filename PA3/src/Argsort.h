@@ -0,0 +1,61 @@
+#ifndef ARGSORT_H
+#define ARGSORT_H
+
+#include <vector>
+#include <cstddef>
+#include <string.h>
+#include "KeyTraits.h"
+
+//Bytes of row number each key carries
+#define ROW_BYTES       8
+
+//Most columns a packed key can hold, every column is at least a bit
+#define MAX_COLUMNS     64
+
+bool parseColumnBits ( const char* list, std::vector<int>& widths );
+unsigned long long packColumns ( const unsigned int* columns, const std::vector<int>& widths );
+void makeColumns ( unsigned long long* keys, long long first, size_t n, const std::vector<int>& widths, unsigned long long seed );
+
+ /**attachRows
+ *@fn void attachRows ( const K* keys, size_t n, long long firstRow, std::vector< Record<K, ROW_BYTES> >& records )
+ *@brief Pairs each key with its row number, which goes along as the record's payload through the sort
+ *@param keys The keys
+ *@param n The number of keys
+ *@param firstRow The row number of the first key
+ *@param records Where the keys and their rows are stored
+ *@return N/A
+ *@pre keys holds n keys
+ *@post records[i] holds keys[i] and firstRow + i
+ */
+template <typename K>
+void attachRows ( const K* keys, size_t n, long long firstRow, std::vector< Record<K, ROW_BYTES> >& records )
+{
+    records.resize ( n );
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        long long row = firstRow + i;
+        records[i].key = keys[i];
+        memcpy ( records[i].payload, &row, sizeof ( row ) );
+    }
+}
+
+ /**detachRows
+ *@fn void detachRows ( const std::vector< Record<K, ROW_BYTES> >& records, std::vector<long long>& rows )
+ *@brief Takes the row numbers back out of sorted records, which is the permutation that sorts the rows
+ *@param records The records
+ *@param rows Where the row numbers are stored
+ *@return N/A
+ *@pre N/A
+ *@post rows[i] is the row number records[i] carries
+ */
+template <typename K>
+void detachRows ( const std::vector< Record<K, ROW_BYTES> >& records, std::vector<long long>& rows )
+{
+    rows.resize ( records.size (  ) );
+
+    for ( size_t i = 0; i < records.size (  ); i++ )
+        memcpy ( &rows[i], records[i].payload, sizeof ( rows[i] ) );
+}
+
+#endif
@@ -0,0 +1,351 @@
+/** @file Compress.cpp
+  * @brief Delta and bit-packing compression for sorted buckets of int keys. A bucket is stored as its first key and
+  *        then the gaps between neighbouring keys in blocks of PACK_BLOCK, each block packed at the bit width of its
+  *        largest gap, so keys that are close together go in a few bits each.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Compress.h"
+#include <string.h>
+#include <algorithm>
+#include "mpi.h"
+
+using namespace std;
+
+static void sampleCompression ( const int* keys, const vector<long long>& sendCounts, int taskid, double& saved,
+                                double& cost );
+
+ /**parseCompression
+ *@fn bool parseCompression ( const char* name, Compression& compression )
+ *@brief Turns off, on or auto into a Compression
+ *@param name The name
+ *@param compression Where the setting is stored
+ *@return false if the name is not a setting
+ *@pre N/A
+ *@post compression is set if true is returned
+ */
+bool parseCompression ( const char* name, Compression& compression )
+{
+    if ( strcmp ( name, "off" ) == 0 )
+        compression = COMPRESS_OFF;
+    else if ( strcmp ( name, "on" ) == 0 )
+        compression = COMPRESS_ON;
+    else if ( strcmp ( name, "auto" ) == 0 )
+        compression = COMPRESS_AUTO;
+    else
+        return false;
+
+    return true;
+}
+
+ /**packedBound
+ *@fn size_t packedBound ( size_t n )
+ *@brief The most bytes packKeys can write for n keys, when every gap needs all 32 bits
+ *@param n The number of keys
+ *@return The number of bytes
+ *@pre N/A
+ *@post N/A
+ */
+size_t packedBound ( size_t n )
+{
+    return n == 0 ? 0 : sizeof ( int ) * n + ( n + PACK_BLOCK - 1 ) / PACK_BLOCK;
+}
+
+ /**packKeys
+ *@fn size_t packKeys ( const int* keys, size_t n, unsigned char* out )
+ *@brief Packs sorted keys as the first key and then blocks of gaps, each block a width byte followed by its gaps at
+ *       that many bits apiece
+ *@param keys The keys
+ *@param n The number of keys
+ *@param out Where the packed bytes are stored
+ *@return The number of bytes written
+ *@pre keys is sorted and out holds packedBound ( n ) bytes
+ *@post out holds the packed keys
+ */
+size_t packKeys ( const int* keys, size_t n, unsigned char* out )
+{
+    if ( n == 0 )
+        return 0;
+
+    unsigned char* at = out;
+    memcpy ( at, &keys[0], sizeof ( int ) );
+    at += sizeof ( int );
+
+    unsigned int previous = keys[0];
+    for ( size_t block = 1; block < n; block += PACK_BLOCK )
+    {
+        size_t count = std::min ( (size_t)PACK_BLOCK, n - block );
+        unsigned int gaps[PACK_BLOCK], used = 0;
+
+        for ( size_t i = 0; i < count; i++ )
+        {
+            gaps[i] = (unsigned int)keys[block + i] - previous;
+            previous = keys[block + i];
+            used |= gaps[i];
+        }
+
+        //The bits the largest gap needs
+        int width = 0;
+        while ( width < 32 && ( used >> width ) != 0 )
+            width++;
+        *at++ = width;
+
+        //Gaps go in low bits first and whole bytes come off the bottom
+        unsigned long long buffer = 0;
+        int bits = 0;
+        for ( size_t i = 0; i < count; i++ )
+        {
+            buffer |= (unsigned long long)gaps[i] << bits;
+            bits += width;
+            for ( ; bits >= 8; bits -= 8, buffer >>= 8 )
+                *at++ = (unsigned char)buffer;
+        }
+        if ( bits > 0 )
+            *at++ = (unsigned char)buffer;
+    }
+
+    return at - out;
+}
+
+ /**unpackKeys
+ *@fn size_t unpackKeys ( const unsigned char* in, size_t n, int* keys )
+ *@brief Unpacks keys packed by packKeys
+ *@param in The packed bytes
+ *@param n The number of keys
+ *@param keys Where the keys are stored
+ *@return The number of bytes read
+ *@pre in holds n keys from packKeys and keys holds n ints
+ *@post keys holds the keys, sorted
+ */
+size_t unpackKeys ( const unsigned char* in, size_t n, int* keys )
+{
+    if ( n == 0 )
+        return 0;
+
+    const unsigned char* at = in;
+    memcpy ( &keys[0], at, sizeof ( int ) );
+    at += sizeof ( int );
+
+    unsigned int previous = keys[0];
+    for ( size_t block = 1; block < n; block += PACK_BLOCK )
+    {
+        size_t count = std::min ( (size_t)PACK_BLOCK, n - block );
+        int width = *at++;
+        unsigned int mask = width == 32 ? 0xffffffffu : ( 1u << width ) - 1;
+
+        unsigned long long buffer = 0;
+        int bits = 0;
+        for ( size_t i = 0; i < count; i++ )
+        {
+            for ( ; bits < width; bits += 8 )
+                buffer |= (unsigned long long)*at++ << bits;
+
+            previous += (unsigned int)buffer & mask;
+            buffer >>= width;
+            bits -= width;
+            keys[block + i] = (int)previous;
+        }
+    }
+
+    return at - in;
+}
+
+ /**networkBandwidth
+ *@fn double networkBandwidth (  )
+ *@brief Times an MPI_Alltoall of PROBE_BYTES to every rank, the second of two so connections are already set up,
+ *       and remembers the answer for later calls. The first call is collective.
+ *@return The bytes per second each rank can send to the others
+ *@pre MPI is initialized
+ *@post The bandwidth is cached
+ */
+double networkBandwidth (  )
+{
+    static double bandwidth = 0;
+
+    if ( bandwidth > 0 )
+        return bandwidth;
+
+    int numRanks;
+    MPI_Comm_size ( MPI_COMM_WORLD, &numRanks );
+
+    vector<char> out ( (size_t)PROBE_BYTES * numRanks ), in ( (size_t)PROBE_BYTES * numRanks );
+    double time = 0;
+
+    for ( int trial = 0; trial < 2; trial++ )
+    {
+        MPI_Barrier ( MPI_COMM_WORLD );
+        double start = MPI_Wtime (  );
+        MPI_Alltoall ( out.data (  ), PROBE_BYTES, MPI_BYTE, in.data (  ), PROBE_BYTES, MPI_BYTE, MPI_COMM_WORLD );
+        time = MPI_Wtime (  ) - start;
+    }
+
+    //The slowest rank sets the pace
+    MPI_Allreduce ( MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD );
+
+    bandwidth = (double)PROBE_BYTES * std::max ( numRanks - 1, 1 ) / std::max ( time, 1e-9 );
+
+    return bandwidth;
+}
+
+ /**exchangeCompressed
+ *@fn void exchangeCompressed ( const int* keys, const std::vector<long long>& sendCounts, int taskid, ExchangeMode exchange, Compression compression, std::vector<int>& bigBucket, std::vector<size_t>& runStarts )
+ *@brief exchangeBuckets for sorted buckets, packing each bucket before it is sent and unpacking it on arrival. With
+ *       COMPRESS_AUTO a block of each bucket is packed and unpacked first, and the ranks only pack the buckets if,
+ *       summed over every rank, the time the smaller messages save at the measured network bandwidth is more than
+ *       the time packing and unpacking will take. This is collective.
+ *@param keys This rank's buckets, back to back in rank order
+ *@param sendCounts The size of each bucket
+ *@param taskid This rank
+ *@param exchange Whether to use MPI_Alltoallv or MPI_Ialltoallv
+ *@param compression Whether to pack the buckets
+ *@param bigBucket Where the keys for this rank are stored
+ *@param runStarts Where the start of each received bucket in bigBucket is stored
+ *@return N/A
+ *@pre Every rank calls this with its own buckets, each one sorted, and the same compression
+ *@post bigBucket holds one sorted run from each rank, in rank order
+ */
+void exchangeCompressed ( const int* keys, const vector<long long>& sendCounts, int taskid, ExchangeMode exchange,
+                          Compression compression, vector<int>& bigBucket, vector<size_t>& runStarts )
+{
+    if ( compression == COMPRESS_OFF )
+    {
+        exchangeBuckets ( keys, sendCounts, taskid, exchange, bigBucket, runStarts );
+        return;
+    }
+
+    if ( compression == COMPRESS_AUTO )
+    {
+        double estimate[2];
+        sampleCompression ( keys, sendCounts, taskid, estimate[0], estimate[1] );
+        endPhase ( PHASE_PARTITION );
+
+        MPI_Allreduce ( MPI_IN_PLACE, estimate, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD );
+
+        if ( estimate[0] <= estimate[1] )
+        {
+            exchangeBuckets ( keys, sendCounts, taskid, exchange, bigBucket, runStarts );
+            return;
+        }
+    }
+
+    int numBuckets = sendCounts.size (  );
+
+    //Pack every bucket back to back
+    size_t bound = 0;
+    for ( int i = 0; i < numBuckets; i++ )
+        bound += packedBound ( sendCounts[i] );
+
+    vector<unsigned char> packed ( bound );
+    vector<long long> sizes ( 2 * numBuckets ), sendBytes ( numBuckets ), sendDispls ( numBuckets );
+    size_t at = 0;
+    const int* bucket = keys;
+
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        sendDispls[i] = at;
+        sendBytes[i] = packKeys ( bucket, sendCounts[i], packed.data (  ) + at );
+        at += sendBytes[i];
+        bucket += sendCounts[i];
+    }
+
+    //Packing is part of getting the buckets ready
+    endPhase ( PHASE_PARTITION );
+
+    //Every rank needs the key count and the byte count of each bucket coming its way
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        sizes[2 * i] = sendCounts[i];
+        sizes[2 * i + 1] = sendBytes[i];
+    }
+
+    vector<long long> recvSizes ( 2 * numBuckets ), recvBytes ( numBuckets ), recvDispls ( numBuckets );
+    MPI_Alltoall ( sizes.data (  ), 2, MPI_LONG_LONG, recvSizes.data (  ), 2, MPI_LONG_LONG, MPI_COMM_WORLD );
+    endPhase ( PHASE_COUNTS );
+
+    size_t received = 0, receivedBytes = 0;
+    runStarts.resize ( numBuckets );
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        runStarts[i] = received;
+        recvBytes[i] = recvSizes[2 * i + 1];
+        recvDispls[i] = receivedBytes;
+        received += recvSizes[2 * i];
+        receivedBytes += recvBytes[i];
+    }
+
+    bigBucket.resize ( received );
+    vector<unsigned char> incoming ( receivedBytes );
+
+    PendingExchange pending;
+    startExchange ( packed.data (  ), sendBytes, sendDispls, incoming.data (  ), recvBytes, recvDispls, MPI_BYTE, taskid,
+                    exchange, pending );
+
+    //Our own bucket is unpacked straight from what we packed while the rest are in flight
+    if ( exchange != EXCHANGE_BLOCKING )
+        unpackKeys ( packed.data (  ) + sendDispls[taskid], sendCounts[taskid], bigBucket.data (  ) + runStarts[taskid] );
+
+    finishExchange ( pending );
+
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        if ( i != taskid || exchange == EXCHANGE_BLOCKING )
+            unpackKeys ( incoming.data (  ) + recvDispls[i], recvSizes[2 * i], bigBucket.data (  ) + runStarts[i] );
+    }
+    endPhase ( PHASE_EXCHANGE );
+}
+
+ /**sampleCompression
+ *@fn void sampleCompression ( const int* keys, const vector<long long>& sendCounts, int taskid, double& saved, double& cost )
+ *@brief Packs and unpacks up to AUTO_SAMPLE keys from the middle of each bucket and scales the sizes and times up
+ *       to the whole buckets. The first call is collective, since it measures the network.
+ *@param keys This rank's buckets, back to back in rank order
+ *@param sendCounts The size of each bucket
+ *@param taskid This rank
+ *@param saved Where the seconds packing would save on the network are stored
+ *@param cost Where the seconds packing and unpacking every bucket would take are stored
+ *@return N/A
+ *@pre Each bucket is sorted
+ *@post saved and cost are set
+ */
+static void sampleCompression ( const int* keys, const vector<long long>& sendCounts, int taskid, double& saved,
+                                double& cost )
+{
+    //Every rank has to measure the network, even one with nothing to send
+    double bandwidth = networkBandwidth (  );
+
+    vector<unsigned char> packed ( packedBound ( AUTO_SAMPLE ) );
+    vector<int> unpacked ( AUTO_SAMPLE );
+    double sampledKeys = 0, sampledBytes = 0, totalKeys = 0, remoteKeys = 0, time = 0;
+    const int* bucket = keys;
+
+    for ( size_t i = 0; i < sendCounts.size (  ); i++ )
+    {
+        size_t n = std::min ( sendCounts[i], (long long)AUTO_SAMPLE );
+        const int* block = bucket + ( sendCounts[i] - n ) / 2;
+        bucket += sendCounts[i];
+
+        if ( n == 0 )
+            continue;
+
+        double start = MPI_Wtime (  );
+        sampledBytes += packKeys ( block, n, packed.data (  ) );
+        unpackKeys ( packed.data (  ), n, unpacked.data (  ) );
+        time += MPI_Wtime (  ) - start;
+
+        sampledKeys += n;
+        totalKeys += sendCounts[i];
+
+        //Only what crosses the network counts toward the saving
+        if ( (int)i != taskid )
+            remoteKeys += sendCounts[i];
+    }
+
+    saved = cost = 0;
+    if ( sampledKeys == 0 )
+        return;
+
+    saved = remoteKeys * ( sizeof ( int ) - sampledBytes / sampledKeys ) / bandwidth;
+    cost = time * totalKeys / sampledKeys;
+}
@@ -0,0 +1,35 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <vector>
+#include <cstddef>
+#include "Exchange.h"
+
+//Deltas per bit-packed block, each block stores its own bit width
+#define PACK_BLOCK      128
+
+//Bytes each rank sends every other rank when the network bandwidth is measured
+#define PROBE_BYTES     ( 1 << 16 )
+
+//Keys from the middle of each bucket packed and unpacked to decide whether auto compression pays
+#define AUTO_SAMPLE     ( PACK_BLOCK * 64 )
+
+//Whether the buckets are compressed for the exchange
+enum Compression
+{
+    COMPRESS_OFF,
+    COMPRESS_ON,
+
+    //Only when packing and unpacking is quicker than sending the bytes saved
+    COMPRESS_AUTO
+};
+
+bool parseCompression ( const char* name, Compression& compression );
+size_t packedBound ( size_t n );
+size_t packKeys ( const int* keys, size_t n, unsigned char* out );
+size_t unpackKeys ( const unsigned char* in, size_t n, int* keys );
+double networkBandwidth (  );
+void exchangeCompressed ( const int* keys, const std::vector<long long>& sendCounts, int taskid, ExchangeMode exchange,
+                          Compression compression, std::vector<int>& bigBucket, std::vector<size_t>& runStarts );
+
+#endif
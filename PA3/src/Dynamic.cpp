@@ -1,273 +1,965 @@
 /** @file Dynamic.cpp
-  * @brief A dynamic implementation of Bucket Sort. 
+  * @brief A dynamic implementation of Bucket Sort. Keys are either bucketed by value range or, in sample mode,
+  *        by splitters chosen from a regular sample so that every rank gets a near-equal share whatever the distribution.
   * @author Tyler DeFoor
   * @date 4/2/2017
-  * @version 1.0
+  * @version 1.1
   */
- 
+
 #include <iostream>
 #include <stdlib.h>
 #include <fstream>
 #include <string.h>
 #include <vector>
 #include <algorithm>
+#include <unistd.h>
 #include "mpi.h"
+#include "LocalSort.h"
+#include "Partition.h"
+#include "KeyFile.h"
+#include "Exchange.h"
+#include "Pipeline.h"
+#include "Random.h"
+#include "Compress.h"
+#include "Tuner.h"
+#include "Select.h"
+#include "GroupBy.h"
+#include "Heavy.h"
+#include "ExternalSort.h"
+#include "Phases.h"
+#include "Argsort.h"
 
 #define MASTER      0
 #define INT_TYPE    MPI_INT
 
 using namespace std;
 
-void bucketsort ( int* unsorted, int* &sorted, int max, int numBuckets, int totalNums );
-void read ( char* filename, int totalNums );
-void bubbleSort(vector<int>& a);
+//How keys are assigned to ranks
+enum PartitionMode
+{
+    //By value range, key / ( max / numBuckets )
+    PARTITION_BUCKET,
+
+    //By splitters chosen from a regular sample of every rank's sorted keys
+    PARTITION_SAMPLE
+};
+
+//The type of the made up keys
+enum KeyType
+{
+    KEY_INT,
+    KEY_LONG,
+    KEY_FLOAT,
+    KEY_DOUBLE,
+
+    //A long long key with PAYLOAD_BYTES of payload
+    KEY_RECORD
+};
+
+#define PAYLOAD_BYTES   8
+
+typedef Record<long long, PAYLOAD_BYTES> PayloadRecord;
+
+//What the command line asked for
+struct RunOptions
+{
+    //How many keys to make up, or the key file to read them from
+    long long totalNums;
+    const char* inputFile;
+
+    //How the made up keys are spread and the seed they come from
+    Distribution distribution;
+    unsigned long long seed;
+
+    //The key file the sorted keys are written to, or NULL
+    const char* outputFile;
+
+    //Megabytes of keys each rank may hold for the external sort, 0 to sort in memory, and where it spills
+    int budget;
+    const char* spillDir;
+
+    SortKind sortKind;
+    PartitionMode mode;
+    ExchangeMode exchange;
+    KeyType keyType;
+
+    //Whether sorted buckets are packed for the exchange, int keys only
+    Compression compression;
+
+    //How many of the smallest keys to find, and the percentiles to find, instead of sorting
+    int smallest;
+    vector<double> percentiles;
+
+    //Whether to group the keys and aggregate a made up value per row instead of sorting
+    bool groupBy;
+
+    //The CSV file each phase's time and the bytes sent to each rank are appended to, or NULL
+    const char* phaseFile;
+
+    //Whether to sort row numbers by key, and the bits of each made up key column packed into one key, if any
+    bool argsort;
+    vector<int> columnBits;
+};
+
+bool parseArguments ( int argc, char** argv, RunOptions& run );
+template <typename R> void sortMadeUp ( const RunOptions& run, int numBuckets, int taskid );
+template <typename R> void sampleSort ( const vector<R>& unsorted, int numBuckets, int taskid, const RunOptions& run, vector<R>& bigBucket );
+template <typename R> void exchangeSorted ( const R* keys, const vector<long long>& sendCounts, int taskid, const RunOptions& run, vector<R>& bigBucket, vector<size_t>& runStarts );
+void exchangeSorted ( const int* keys, const vector<long long>& sendCounts, int taskid, const RunOptions& run, vector<int>& bigBucket, vector<size_t>& runStarts );
+template <typename K> bool argsortKeys ( const vector<K>& keys, const RunOptions& run, long long totalNums, int numBuckets, int taskid );
+template <typename R> void chooseSplitters ( const vector<R>& sorted, int numBuckets, vector<typename RecordTraits<R>::Key>& splitters );
+void randomKey ( long long& key, long long index, unsigned long long seed );
+void randomKey ( float& key, long long index, unsigned long long seed );
+void randomKey ( double& key, long long index, unsigned long long seed );
+void randomKey ( PayloadRecord& record, long long index, unsigned long long seed );
 
 int main ( int argc, char** argv )
 {
 
     /* Variable Declarations */
-    //The filename
-    //char* filename = argv[1];
-    
-    //Read in the total number of numbers
-    int totalNums = atoi(argv[1]);
+    //Read in the total number of numbers or the key file, how to sort each bucket, how to pick the buckets and how to move them
+    RunOptions run;
+    bool parsed = parseArguments ( argc, argv, run );
+    long long totalNums = run.totalNums;
 
     //A static maximum
     int max = 100000;
 
-    //The total number of buckets, taskid, and a counter variable
-    int numBuckets, taskid, count;
+    //The total number of buckets and taskid
+    int numBuckets, taskid;
 
     //The unsorted array of ints
-    int* unsorted;
+    vector<int> unsorted;
 
     //The start, end, and total time
     double start, end, total;
 
-    fstream fin;
-
     /* End of Variable Declarations */
     //Initialize MPI
     MPI_Init ( &argc, &argv );
 
-    MPI_Status status;
-
     //Get the world size
     MPI_Comm_size ( MPI_COMM_WORLD, &numBuckets );
 
     //Get Rank
     MPI_Comm_rank ( MPI_COMM_WORLD, &taskid );
 
+    if ( !parsed )
+    {
+        if ( taskid == MASTER )
+            cerr << "Usage: " << argv[0] << " [-m bucket|sample] [-e blocking|nonblocking|pipelined] [-k auto|radix|intro|network|flag]\n"
+                 << "         [-g uniform|zipf|gaussian|sorted|reverse|few|equal] [-s seed] [-z off|on|auto] [-c phaseCsv] totalNums | -f keyFile [-o sortedFile]\n"
+                 << "       " << argv[0] << " -y long|float|double|record [-e blocking|nonblocking] [-k auto|radix|intro|network|flag] [-s seed] [-c phaseCsv] totalNums\n"
+                 << "       " << argv[0] << " -x budgetMB [-d spillDir] [-k auto|radix|intro|network|flag] -f keyFile -o sortedFile\n"
+                 << "       " << argv[0] << " [-n smallest] [-p percentile,...] [-g distribution] [-s seed] totalNums | -f keyFile [-o smallestFile]\n"
+                 << "       " << argv[0] << " -a [-e blocking|nonblocking] [-g distribution] [-s seed] totalNums | -f keyFile [-o groupFile]\n"
+                 << "       " << argv[0] << " -r [-e blocking|nonblocking] [-g distribution] [-s seed] [-c phaseCsv] totalNums | -f keyFile [-o rowFile]\n"
+                 << "       " << argv[0] << " -l bits,... [-e blocking|nonblocking] [-s seed] [-c phaseCsv] totalNums [-o rowFile]" << endl;
+        MPI_Finalize (  );
+        return 1;
+    }
 
-    //If we are the master
-    if ( taskid == MASTER )
+    //Keys other than ints are made up on each rank and sample sorted
+    if ( run.keyType != KEY_INT )
     {
-        //A try catch for opening files because I'm a good programmer
-        /*
-        try
+        switch ( run.keyType )
         {
-            fin.open ( filename );
+            case KEY_LONG:   sortMadeUp<long long> ( run, numBuckets, taskid ); break;
+            case KEY_FLOAT:  sortMadeUp<float> ( run, numBuckets, taskid ); break;
+            case KEY_DOUBLE: sortMadeUp<double> ( run, numBuckets, taskid ); break;
+            default:         sortMadeUp<PayloadRecord> ( run, numBuckets, taskid ); break;
         }
-        catch ( const ifstream::failure& e )
+
+        MPI_Finalize (  );
+        return 0;
+    }
+
+    //Several made up key columns are packed into one key, and their row numbers sorted by it
+    if ( !run.columnBits.empty (  ) )
+    {
+        long long first, count;
+        sliceOf ( totalNums, numBuckets, taskid, first, count );
+
+        startPhases ( numBuckets );
+        vector<unsigned long long> packed ( count );
+        makeColumns ( packed.data (  ), first, count, run.columnBits, run.seed );
+        endPhase ( PHASE_LOAD );
+
+        bool written = argsortKeys ( packed, run, totalNums, numBuckets, taskid );
+
+        MPI_Finalize (  );
+        return written ? 0 : 1;
+    }
+
+    //Sort a key file too big for memory through spill files
+    if ( run.budget > 0 )
+    {
+        long long fileNums;
+
+        MPI_Barrier ( MPI_COMM_WORLD );
+        start = MPI_Wtime (  );
+
+        bool sorted = externalSort ( run.inputFile, run.outputFile, run.spillDir, (size_t)run.budget << 20, run.sortKind, fileNums );
+
+        end = MPI_Wtime (  );
+
+        if ( taskid == MASTER )
         {
-            cout << "File failure: Try again later" << endl;
+            if ( sorted )
+                cout << numBuckets << " " << fileNums << " " << end - start << endl;
+            else
+                cerr << "Could not sort " << run.inputFile << " into " << run.outputFile << endl;
         }
-        */
-        //Get the total number of ints
-        //fin >> totalNums;
 
-        //Broadcast the total numbers to all processes
-        MPI_Bcast ( &totalNums, 1, MPI_INT, MASTER, MPI_COMM_WORLD );
+        MPI_Finalize (  );
+        return sorted ? 0 : 1;
+    }
+
+    //Time every rank's share of each phase from here
+    startPhases ( numBuckets );
 
-        //The unsorted array
-        unsorted = new int[( totalNums / numBuckets )];
+    //Every rank reads its own slice of the key file
+    if ( run.inputFile )
+    {
+        long long fileNums;
 
-        //Read in the numbers and send to the slaves
-        for ( int i = 1; i < numBuckets; i++ )
+        if ( !readKeyFile ( run.inputFile, MPI_COMM_WORLD, unsorted, fileNums ) )
         {
-            for ( int j = 0; j < (totalNums / numBuckets); j++ )
-            {
-                //fin >> unsorted[j];
-                unsorted[j] = (rand (  ) % max);
-                //Check for the max
-                /*if ( unsorted[j] > max )
-                    max = unsorted[j];*/
-            }
+            if ( taskid == MASTER )
+                cerr << "Could not read " << run.inputFile << endl;
+            MPI_Finalize (  );
+            return 1;
+        }
 
-            MPI_Send ( unsorted, (totalNums / numBuckets), MPI_INT, i, 0, MPI_COMM_WORLD );
+        totalNums = fileNums;
+
+        //The keys can be anything, so find their range
+        //The min is negated so one MPI_MAX finds both, in long long since the smallest int has no negation
+        long long range[2] = { -0x7fffffffLL - 1, -0x7fffffffLL - 1 };
+        for ( size_t i = 0; i < unsorted.size (  ); i++ )
+        {
+            range[0] = std::max ( range[0], -(long long)unsorted[i] );
+            range[1] = std::max ( range[1], (long long)unsorted[i] );
         }
 
-        //Read in what the master takes care of
-        for ( int i = 0; i < ( totalNums / numBuckets ); i++ )
+        MPI_Allreduce ( MPI_IN_PLACE, range, 2, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD );
+
+        if ( run.mode == PARTITION_BUCKET && run.smallest == 0 && run.percentiles.empty (  ) && !run.groupBy && ( range[0] > 0 || range[1] == 0x7fffffff ) )
         {
-            //fin >> unsorted[i];
-            unsorted[i] = (rand (  ) % max);
-            //Check for the max again
-            /*if ( unsorted[i] > max )
-                max = unsorted[i];*/
+            if ( taskid == MASTER )
+                cerr << "Bucket mode needs keys from 0 up to 2147483646, use -m sample" << endl;
+            MPI_Finalize (  );
+            return 1;
         }
 
-        //For super secret purposes
+        //Only bucket mode uses it, where the largest key is below 0x7fffffff
+        max = (int)std::min ( range[1] + 1, 0x7fffffffLL );
+    }
+    //Every rank makes up its own slice of the keys, the same keys whatever the number of ranks
+    else
+    {
+        long long first, count;
+        sliceOf ( totalNums, numBuckets, taskid, first, count );
 
-        //Broadcast the max to all processes
-        MPI_Bcast ( &max, 1, MPI_INT, MASTER, MPI_COMM_WORLD );
-        //Close the file
-        fin.close (  );
+        unsorted.resize ( count );
+        generateKeys ( unsorted.data (  ), first, count, totalNums, max, run.distribution, run.seed );
+    }
+    endPhase ( PHASE_LOAD );
 
-        //The bucket the number is supposed to go to
-        int myBucket = max / numBuckets;
+    //The row numbers are sorted by key instead of the keys
+    if ( run.argsort )
+    {
+        bool written = argsortKeys ( unsorted, run, totalNums, numBuckets, taskid );
 
-        //Create a vector of ints because vectors are great
-        vector<int> buckets[numBuckets];
+        MPI_Finalize (  );
+        return written ? 0 : 1;
+    }
 
-        //Temp to hold a small bucket before transferring to big bucket
-        int* temp = new int[( totalNums / numBuckets )];
+    //Selection needs a few passes over the keys and no sort
+    if ( run.smallest > 0 || !run.percentiles.empty (  ) )
+    {
+        vector<int> smallest, values;
+        bool selected = true;
 
-        //Block because we all want to start at the same time
         MPI_Barrier ( MPI_COMM_WORLD );
+        start = MPI_Wtime (  );
+
+        if ( run.smallest > 0 )
+            smallestKeys ( unsorted.data (  ), unsorted.size (  ), run.smallest, MASTER, MPI_COMM_WORLD, smallest );
+        if ( !run.percentiles.empty (  ) )
+            selected = selectPercentiles ( unsorted.data (  ), unsorted.size (  ), run.percentiles, values, MPI_COMM_WORLD );
 
-        //Start the timer
+        end = MPI_Wtime (  );
+
+        //An empty key file has no percentiles
+        if ( !selected )
+        {
+            if ( taskid == MASTER )
+                cerr << "No keys to find percentiles of" << endl;
+            MPI_Finalize (  );
+            return 1;
+        }
+
+        if ( taskid == MASTER )
+        {
+            cout << numBuckets << " " << totalNums << " " << end - start << endl;
+
+            for ( size_t i = 0; i < values.size (  ); i++ )
+                cout << "p" << run.percentiles[i] << " " << values[i] << endl;
+
+            //The smallest keys go to the output file if there is one
+            for ( size_t i = 0; !run.outputFile && i < smallest.size (  ); i++ )
+                cout << smallest[i] << ( i + 1 < smallest.size (  ) ? " " : "\n" );
+        }
+
+        bool written = !run.outputFile || writeKeyFileAll ( run.outputFile, MPI_COMM_WORLD, smallest.data (  ), smallest.size (  ) );
+        if ( !written && taskid == MASTER )
+            cerr << "Could not write " << run.outputFile << endl;
+
+        MPI_Finalize (  );
+        return written ? 0 : 1;
+    }
+
+    //Group by key, every row's value made up from its row number like the keys are
+    if ( run.groupBy )
+    {
+        long long rows = unsorted.size (  ), first = 0;
+        MPI_Exscan ( &rows, &first, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+        if ( taskid == MASTER )
+            first = 0;
+
+        vector<int> values ( rows );
+        makeValues ( values.data (  ), first, rows, run.seed );
+
+        vector<Aggregate> groups;
+        long long counts[3], totals[3];
+
+        MPI_Barrier ( MPI_COMM_WORLD );
         start = MPI_Wtime (  );
 
-        //Put them in their buckets
-        for ( int i = 0; i < (totalNums / numBuckets); i++ )
+        groupBy ( unsorted.data (  ), values.data (  ), rows, taskid, run.exchange, groups, counts[1], counts[2] );
+
+        end = MPI_Wtime (  );
+
+        //Groups, bytes sent and the bytes the rows would have been without combining
+        counts[0] = groups.size (  );
+        MPI_Reduce ( counts, totals, 3, MPI_LONG_LONG, MPI_SUM, MASTER, MPI_COMM_WORLD );
+
+        if ( taskid == MASTER )
+        {
+            cout << numBuckets << " " << totalNums << " " << end - start << endl;
+            cout << totals[0] << " groups, " << totals[1] << " bytes sent, " << totals[2] << " bytes uncombined" << endl;
+        }
+
+        //Each rank's groups go out in key order
+        bool written = true;
+        if ( run.outputFile )
         {
-            buckets[unsorted[i] / myBucket].push_back ( unsorted[i] );
+            localSort ( groups, run.sortKind );
+            written = writeGroups ( run.outputFile, MPI_COMM_WORLD, groups );
+            if ( !written && taskid == MASTER )
+                cerr << "Could not write " << run.outputFile << endl;
         }
 
-        //Put our bucket in the big bucket
-        vector<int> bigBucket (buckets[taskid]);
+        MPI_Finalize (  );
+        return written ? 0 : 1;
+    }
 
-        //Send and receive to the big buckets
-        for ( int i = 0; i < numBuckets; i++ )
+    //How many keys this rank sends to each rank
+    vector<long long> sendCounts ( numBuckets );
+
+    //The keys this rank ends up with and where each sender's run of them starts
+    vector<int> bigBucket;
+    vector<size_t> runStarts;
+
+    //Tune the fan-out before the timer, it is only timed the first time on a machine
+    partitionFanOut (  );
+
+    //Block because we all want to start at the same time
+    MPI_Barrier ( MPI_COMM_WORLD );
+
+    //Start the timer
+    start = MPI_Wtime (  );
+    markPhase (  );
+
+    //Keys too common for one rank are taken out and only counted, so they are never sent or sorted
+    vector<KeyRun> heavyRuns;
+    splitHeavyKeys ( unsorted, MPI_COMM_WORLD, heavyRuns );
+    endPhase ( PHASE_PARTITION );
+
+    //How many keys this rank has
+    size_t myNums = unsorted.size (  );
+
+    if ( run.mode == PARTITION_BUCKET )
+    {
+        //The bucket the number is supposed to go to
+        int myBucket = max / numBuckets > 0 ? max / numBuckets : 1;
+
+        if ( run.exchange == EXCHANGE_PIPELINED )
+        {
+            //Partition, send and sort a block at a time
+            RangeBuckets<int> bucketOf = { myBucket, numBuckets };
+            pipelinedSort ( unsorted.data (  ), myNums, numBuckets, taskid, bucketOf, run.sortKind, bigBucket );
+
+            //The phases overlap, so it all counts as the exchange
+            endPhase ( PHASE_EXCHANGE );
+        }
+        else
         {
-            if ( i == taskid )
+            //Put them in their buckets, back to back, the top bucket also takes the remainder when max does not divide evenly
+            vector<int> outgoing ( myNums );
+            vector<size_t> bucketStarts;
+            partitionKeys ( unsorted.data (  ), myNums, numBuckets, myBucket, outgoing.data (  ), bucketStarts );
+
+            for ( int i = 0; i < numBuckets; i++ )
+                sendCounts[i] = bucketStarts[i + 1] - bucketStarts[i];
+            endPhase ( PHASE_PARTITION );
+
+            if ( run.compression == COMPRESS_OFF )
             {
-                //Receive the small buckets
-                for ( int j = 0; j < numBuckets - 1; j++ )
-                {
-                    //Receive a small bucket
-                    MPI_Recv ( temp, ( totalNums / numBuckets ), MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status );
-
-                    //Get the number of things receieved
-                    MPI_Get_count(&status, MPI_INT, &count);
-
-                    //Put the small bucket into the big bucket
-                    for (int k = 0; k < count; k++ )
-                        bigBucket.push_back ( temp[k] );
-                }
+                //Send and receive to the big buckets
+                exchangeBuckets ( outgoing.data (  ), sendCounts, taskid, run.exchange, bigBucket, runStarts );
+
+                //Sort the bucket by splitting it again into buckets that fit in cache
+                int low = taskid * myBucket, high = taskid == numBuckets - 1 ? max : low + myBucket;
+                vector<int> sortedBucket ( bigBucket.size (  ) );
+                bucketSortKeys ( bigBucket.data (  ), bigBucket.size (  ), low, high, 0, run.sortKind, sortedBucket.data (  ) );
+                bigBucket.swap ( sortedBucket );
+                endPhase ( PHASE_SORT );
             }
             else
             {
-                //Send the small bucket to the slave
-                MPI_Send ( &(buckets[i].front (  )), buckets[i].size (  ), MPI_INT, i, 0, MPI_COMM_WORLD );
+                //Sorted buckets pack into small gaps, and arrive as runs that only need merging
+                for ( int i = 0; i < numBuckets; i++ )
+                    localSort ( outgoing.data (  ) + bucketStarts[i], sendCounts[i], run.sortKind );
+                endPhase ( PHASE_SORT );
+
+                exchangeCompressed ( outgoing.data (  ), sendCounts, taskid, run.exchange, run.compression, bigBucket, runStarts );
+                mergeRuns ( bigBucket, runStarts );
+                endPhase ( PHASE_SORT );
             }
         }
+    }
+    else
+        sampleSort ( unsorted, numBuckets, taskid, run, bigBucket );
 
-        //Bubble sort the bucket
-        bubbleSort ( bigBucket );
-
-        //End the timer
-        end = MPI_Wtime (  );
+    //End the timer
+    end = MPI_Wtime (  );
 
+    if ( taskid == MASTER )
+    {
         //Calculate the total time
         total = end - start;
 
         //Output the time for totalNums
         cout << numBuckets << " " << totalNums << " " << total << endl;
     }
-    //If we are a slave
-    else
+
+    //Every rank writes its keys straight after the keys of the ranks before it, and its share of every heavy run
+    bool written = true;
+    if ( run.outputFile )
+    {
+        written = heavyRuns.empty (  )
+                       ? writeKeyFileAll ( run.outputFile, MPI_COMM_WORLD, bigBucket.data (  ), bigBucket.size (  ) )
+                       : writeKeyFileRuns ( run.outputFile, MPI_COMM_WORLD, bigBucket.data (  ), bigBucket.size (  ), heavyRuns );
+
+        if ( !written && taskid == MASTER )
+            cerr << "Could not write " << run.outputFile << endl;
+        endPhase ( PHASE_OUTPUT );
+    }
+
+    //Every phase's min, max and mean over the ranks
+    if ( run.phaseFile && !reportPhases ( run.phaseFile, totalNums, MPI_COMM_WORLD ) && taskid == MASTER )
+        cerr << "Could not write " << run.phaseFile << endl;
+
+    //Finalize MPI
+    MPI_Finalize();
+
+    return written ? 0 : 1;
+}
+
+ /**sortMadeUp
+ *@fn void sortMadeUp ( const RunOptions& run, int numBuckets, int taskid )
+ *@brief Every rank makes up its share of random records and they are sample sorted and timed. This is collective.
+ *@param run The options
+ *@param numBuckets The number of ranks
+ *@param taskid This rank
+ *@return N/A
+ *@pre Every rank calls this with the same record type
+ *@post The master has printed the time, and appended each phase to -c's file if there is one
+ */
+template <typename R>
+void sortMadeUp ( const RunOptions& run, int numBuckets, int taskid )
+{
+    long long first, count;
+    sliceOf ( run.totalNums, numBuckets, taskid, first, count );
+
+    //Each rank makes up its own slice of the keys
+    startPhases ( numBuckets );
+    vector<R> unsorted ( count ), bigBucket;
+    for ( size_t i = 0; i < unsorted.size (  ); i++ )
+        randomKey ( unsorted[i], first + i, run.seed );
+    endPhase ( PHASE_LOAD );
+
+    //Block because we all want to start at the same time
+    MPI_Barrier ( MPI_COMM_WORLD );
+    double start = MPI_Wtime (  );
+    markPhase (  );
+
+    sampleSort ( unsorted, numBuckets, taskid, run, bigBucket );
+
+    double end = MPI_Wtime (  );
+
+    if ( taskid == MASTER )
+        cout << numBuckets << " " << run.totalNums << " " << end - start << endl;
+
+    if ( run.phaseFile && !reportPhases ( run.phaseFile, run.totalNums, MPI_COMM_WORLD ) && taskid == MASTER )
+        cerr << "Could not write " << run.phaseFile << endl;
+}
+
+ /**argsortKeys
+ *@fn bool argsortKeys ( const vector<K>& keys, const RunOptions& run, long long totalNums, int numBuckets, int taskid )
+ *@brief Numbers every key by its row, rank 0's first, and sample sorts the keys with their row numbers along, timing
+ *       it like a sort. Radix sort keeps equal keys in order, equal keys all go to the same rank, and the runs that
+ *       come in are merged in rank order, so keys that are equal stay in row order. With -o the row numbers are
+ *       written in sorted order, the permutation that sorts the rows. This is collective.
+ *@param keys This rank's keys, the rows after the rows of the ranks before it
+ *@param run The options
+ *@param totalNums The number of keys over every rank
+ *@param numBuckets The number of ranks
+ *@param taskid This rank
+ *@return false on every rank if the row file could not be written
+ *@pre Every rank calls this with its own keys and run.sortKind is SORT_RADIX
+ *@post The master has printed the time, and the permutation is written if -o asked for it
+ */
+template <typename K>
+bool argsortKeys ( const vector<K>& keys, const RunOptions& run, long long totalNums, int numBuckets, int taskid )
+{
+    //Rows are numbered in rank order
+    long long count = keys.size (  ), first = 0;
+    MPI_Exscan ( &count, &first, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+    if ( taskid == MASTER )
+        first = 0;
+
+    vector< Record<K, ROW_BYTES> > unsorted, bigBucket;
+    attachRows ( keys.data (  ), keys.size (  ), first, unsorted );
+    endPhase ( PHASE_LOAD );
+
+    //Block because we all want to start at the same time
+    MPI_Barrier ( MPI_COMM_WORLD );
+    double start = MPI_Wtime (  );
+    markPhase (  );
+
+    sampleSort ( unsorted, numBuckets, taskid, run, bigBucket );
+
+    double end = MPI_Wtime (  );
+
+    if ( taskid == MASTER )
+        cout << numBuckets << " " << totalNums << " " << end - start << endl;
+
+    bool written = true;
+    if ( run.outputFile )
     {
-        //Receive the total numbers
-        MPI_Bcast ( &totalNums, 1, MPI_INT, MASTER, MPI_COMM_WORLD );
+        vector<long long> rows;
+        detachRows ( bigBucket, rows );
 
-        //Allocate the unsorted array
-        unsorted = new int[(totalNums / numBuckets)];
+        written = writeRowFileAll ( run.outputFile, MPI_COMM_WORLD, rows.data (  ), rows.size (  ) );
+        if ( !written && taskid == MASTER )
+            cerr << "Could not write " << run.outputFile << endl;
+        endPhase ( PHASE_OUTPUT );
+    }
 
-        //Receive the unsorted array
-        MPI_Recv ( unsorted, (totalNums / numBuckets), MPI_INT, MASTER, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+    if ( run.phaseFile && !reportPhases ( run.phaseFile, totalNums, MPI_COMM_WORLD ) && taskid == MASTER )
+        cerr << "Could not write " << run.phaseFile << endl;
 
-        //Receive the max
-        MPI_Bcast ( &max, 1, MPI_INT, MASTER, MPI_COMM_WORLD );
+    return written;
+}
 
-        //The bucket the number is supposed to go to
-        int myBucket = max / numBuckets;
+ /**sampleSort
+ *@fn void sampleSort ( const vector<R>& unsorted, int numBuckets, int taskid, const RunOptions& run, vector<R>& bigBucket )
+ *@brief Sorts this rank's records, cuts them at splitters every rank agrees on, sends each range to its rank and
+ *       merges the sorted runs that come in. This is collective.
+ *@param unsorted This rank's records
+ *@param numBuckets The number of ranks
+ *@param taskid This rank
+ *@param run The options
+ *@param bigBucket Where the records for this rank are stored
+ *@return N/A
+ *@pre Every rank calls this with its own records
+ *@post bigBucket is sorted and comes after every record of the ranks before this one
+ */
+template <typename R>
+void sampleSort ( const vector<R>& unsorted, int numBuckets, int taskid, const RunOptions& run, vector<R>& bigBucket )
+{
+    typedef typename RecordTraits<R>::Key Key;
 
-        //Create a vector of ints because vectors are great
-        vector<int> buckets[numBuckets];
+    vector<long long> sendCounts ( numBuckets );
+    vector<size_t> runStarts;
 
-        int* temp = new int[(totalNums / numBuckets)];
+    //Sort what we have so every outgoing bucket is a sorted, contiguous range
+    vector<R> sorted ( unsorted );
+    localSort ( sorted, run.sortKind );
+    endPhase ( PHASE_SORT );
 
-        //Block because we all want to start at the same time
-        MPI_Barrier ( MPI_COMM_WORLD );
+    //Every rank agrees on the same splitters
+    vector<Key> splitters;
+    chooseSplitters ( sorted, numBuckets, splitters );
+
+    //Keys up to and including splitter i go to rank i, so the buckets are already back to back
+    typename vector<R>::iterator from = sorted.begin (  );
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        typename vector<R>::iterator to = sorted.end (  );
+        if ( i < numBuckets - 1 )
+            to = upper_bound ( from, sorted.end (  ), KeyTraits<Key>::toBits ( splitters[i] ), bitsLess<R> );
+        sendCounts[i] = to - from;
+        from = to;
+    }
+    endPhase ( PHASE_PARTITION );
 
-        //Put them in their buckets
-        for ( int i = 0; i < (totalNums / numBuckets); i++ ) 
-            buckets[unsorted[i] / myBucket].push_back ( unsorted[i] );
+    //Send and receive to the big buckets, which arrive as one sorted run per sender
+    exchangeSorted ( sorted.data (  ), sendCounts, taskid, run, bigBucket, runStarts );
 
-        //
-        vector<int> bigBucket (buckets[taskid]);
+    //Merge the runs
+    mergeRuns ( bigBucket, runStarts );
+    endPhase ( PHASE_SORT );
+}
 
-        //Send and receive to the big buckets
-        for ( int i = 0; i < numBuckets; i++ )
-        {
-            if ( i == taskid )
-            {
-                //Receive the small buckets
-                for ( int j = 0; j < numBuckets - 1; j++ )
-                {
-                    //Receive a small bucket
-                    MPI_Recv ( temp, ( totalNums / numBuckets ), MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status );
-
-                    //Get the number of things receieved
-                    MPI_Get_count(&status, MPI_INT, &count);
-
-                    //Put the small bucket into the big bucket
-                    for (int k = 0; k < count; k++ )
-                        bigBucket.push_back ( temp[k] );
-                }
-            }
-            else
-            {
-                //Send the small bucket to the slave
-                MPI_Send ( &(buckets[i].front (  )), buckets[i].size (  ), MPI_INT, i, 0, MPI_COMM_WORLD );
-            }
-        }
+ /**exchangeSorted
+ *@fn void exchangeSorted ( const R* keys, const vector<long long>& sendCounts, int taskid, const RunOptions& run, vector<R>& bigBucket, vector<size_t>& runStarts )
+ *@brief Exchanges sorted buckets of records, which are never compressed. This is collective.
+ *@param keys This rank's buckets, back to back in rank order
+ *@param sendCounts The size of each bucket
+ *@param taskid This rank
+ *@param run The options
+ *@param bigBucket Where the records for this rank are stored
+ *@param runStarts Where the start of each received bucket in bigBucket is stored
+ *@return N/A
+ *@pre Every rank calls this with its own buckets
+ *@post bigBucket holds one sorted run from each rank, in rank order
+ */
+template <typename R>
+void exchangeSorted ( const R* keys, const vector<long long>& sendCounts, int taskid, const RunOptions& run, vector<R>& bigBucket, vector<size_t>& runStarts )
+{
+    exchangeBuckets ( keys, sendCounts, taskid, run.exchange, bigBucket, runStarts );
+}
 
-        //Bubble sort the bucket
-        bubbleSort ( bigBucket );
+ /**exchangeSorted
+ *@fn void exchangeSorted ( const int* keys, const vector<long long>& sendCounts, int taskid, const RunOptions& run, vector<int>& bigBucket, vector<size_t>& runStarts )
+ *@brief Exchanges sorted buckets of ints, packed if -z asked for it. This is collective.
+ *@param keys This rank's buckets, back to back in rank order
+ *@param sendCounts The size of each bucket
+ *@param taskid This rank
+ *@param run The options
+ *@param bigBucket Where the keys for this rank are stored
+ *@param runStarts Where the start of each received bucket in bigBucket is stored
+ *@return N/A
+ *@pre Every rank calls this with its own buckets
+ *@post bigBucket holds one sorted run from each rank, in rank order
+ */
+void exchangeSorted ( const int* keys, const vector<long long>& sendCounts, int taskid, const RunOptions& run, vector<int>& bigBucket, vector<size_t>& runStarts )
+{
+    exchangeCompressed ( keys, sendCounts, taskid, run.exchange, run.compression, bigBucket, runStarts );
+}
+
+ /**chooseSplitters
+ *@fn void chooseSplitters ( const vector<R>& sorted, int numBuckets, vector<typename RecordTraits<R>::Key>& splitters )
+ *@brief Regular sampling: every rank takes numBuckets evenly spaced keys from its sorted records, the samples are
+ *       allgathered and sorted, and numBuckets - 1 evenly spaced samples become the splitters. A rank with no records
+ *       sends no samples. This is collective.
+ *@param sorted This rank's records, sorted
+ *@param numBuckets The number of ranks
+ *@param splitters Where the numBuckets - 1 splitters are stored
+ *@return N/A
+ *@pre Every rank calls this with its own sorted records
+ *@post splitters is the same on every rank and in ascending order
+ */
+template <typename R>
+void chooseSplitters ( const vector<R>& sorted, int numBuckets, vector<typename RecordTraits<R>::Key>& splitters )
+{
+    typedef typename RecordTraits<R>::Key Key;
+
+    int numSamples = sorted.empty (  ) ? 0 : numBuckets;
+    vector<Key> samples ( numSamples );
+    vector<int> counts ( numBuckets ), displacements ( numBuckets );
+
+    for ( int i = 0; i < numSamples; i++ )
+        samples[i] = RecordTraits<R>::key ( sorted[( sorted.size (  ) * i ) / numBuckets] );
+
+    MPI_Allgather ( &numSamples, 1, MPI_INT, counts.data (  ), 1, MPI_INT, MPI_COMM_WORLD );
+
+    int total = 0;
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        displacements[i] = total;
+        total += counts[i];
     }
-    //Finalize MPI
-    MPI_Finalize();
 
-    return 0;
+    vector<Key> allSamples ( total );
+    MPI_Allgatherv ( samples.data (  ), numSamples, KeyTraits<Key>::datatype (  ), allSamples.data (  ), counts.data (  ),
+                     displacements.data (  ), KeyTraits<Key>::datatype (  ), MPI_COMM_WORLD );
+
+    sort ( allSamples.begin (  ), allSamples.end (  ), keyLess<Key> );
+
+    //Take the middle of each group of total / numBuckets samples
+    splitters.assign ( numBuckets - 1, Key (  ) );
+    for ( int i = 1; total > 0 && i < numBuckets; i++ )
+        splitters[i - 1] = allSamples[std::max ( (long long)i * total / numBuckets + total / ( 2 * numBuckets ) - 1, 0LL )];
 }
 
- /**bubblesort
- *@fn void bubbleSort(vector<int>& a)
- *@brief Sorts a vector using bubblesort
- *@param a The vector to be sorted
+ /**randomKey
+ *@fn void randomKey ( long long& key, long long index, unsigned long long seed )
+ *@brief Makes up a key spread over the whole range, negatives included
+ *@param key Where the key is stored
+ *@param index Which key this is
+ *@param seed The seed
  *@return N/A
- *@pre a contains relevant data
- *@post a is sorted
+ *@pre N/A
+ *@post key is set, the same for the same index and seed
  */
-void bubbleSort(vector<int>& a)
+void randomKey ( long long& key, long long index, unsigned long long seed )
 {
-    bool swap = true;
+    unsigned int bits[4];
+    philox ( index, seed, bits );
+    key = (long long)( ( (unsigned long long)bits[0] << 32 ) | bits[1] );
+}
 
-    while(swap)
+ /**randomKey
+ *@fn void randomKey ( float& key, long long index, unsigned long long seed )
+ *@brief Makes up a key from -1000000 to 1000000
+ *@param key Where the key is stored
+ *@param index Which key this is
+ *@param seed The seed
+ *@return N/A
+ *@pre N/A
+ *@post key is set, the same for the same index and seed
+ */
+void randomKey ( float& key, long long index, unsigned long long seed )
+{
+    unsigned int bits[4];
+    philox ( index, seed, bits );
+    key = ( bits[0] / (float)4294967295.0 - 0.5f ) * 2e6f;
+}
+
+ /**randomKey
+ *@fn void randomKey ( double& key, long long index, unsigned long long seed )
+ *@brief Makes up a key from -1000000 to 1000000
+ *@param key Where the key is stored
+ *@param index Which key this is
+ *@param seed The seed
+ *@return N/A
+ *@pre N/A
+ *@post key is set, the same for the same index and seed
+ */
+void randomKey ( double& key, long long index, unsigned long long seed )
+{
+    unsigned int bits[4];
+    philox ( index, seed, bits );
+    key = ( bits[0] / (double)4294967295.0 - 0.5 ) * 2e6;
+}
+
+ /**randomKey
+ *@fn void randomKey ( PayloadRecord& record, long long index, unsigned long long seed )
+ *@brief Makes up a key and fills the payload with a checksum of it, so a payload that came apart from its key shows
+ *@param record Where the record is stored
+ *@param index Which record this is
+ *@param seed The seed
+ *@return N/A
+ *@pre N/A
+ *@post record is set
+ */
+void randomKey ( PayloadRecord& record, long long index, unsigned long long seed )
+{
+    randomKey ( record.key, index, seed );
+    for ( int i = 0; i < PAYLOAD_BYTES; i++ )
+        record.payload[i] = (char)( record.key >> ( i * 8 ) ) ^ 0x5a;
+}
+
+ /**parseArguments
+ *@fn bool parseArguments ( int argc, char** argv, RunOptions& run )
+ *@brief Reads [-m bucket|sample] [-e blocking|nonblocking|pipelined] [-k auto|radix|intro|network|flag] [-g distribution]
+ *       [-s seed] [-z off|on|auto] totalNums | -f keyFile [-o sortedFile], or -x budgetMB [-d spillDir] for the external sort, which needs
+ *       both -f and -o, or -y long|float|double|record to sample sort uniform made up keys of another type. -n and -p
+ *       find the smallest keys and the keys at some percentiles instead of sorting, and -a groups the keys and
+ *       aggregates a made up value per row.
+ *@param argc The argument count
+ *@param argv The arguments
+ *@param run Where the options are stored
+ *@return false if the arguments are not understood
+ *@pre N/A
+ *@post run is filled in if true is returned, with bucket mode, the blocking exchange, SORT_AUTO, uniform keys from
+ *      DEFAULT_SEED, no compression, no files and an in memory sort unless asked for. Spill files go in $TMPDIR or /tmp unless -d is given.
+ */
+bool parseArguments ( int argc, char** argv, RunOptions& run )
+{
+    int option;
+
+    //Whether -m, -e or -z was given, since the external sort has no use for any of them
+    bool exchangeGiven = false;
+
+    run.totalNums = 0;
+    run.inputFile = NULL;
+    run.distribution = DIST_UNIFORM;
+    run.seed = DEFAULT_SEED;
+    run.outputFile = NULL;
+    run.budget = 0;
+    run.spillDir = getenv ( "TMPDIR" ) ? getenv ( "TMPDIR" ) : "/tmp";
+    run.sortKind = SORT_AUTO;
+    run.mode = PARTITION_BUCKET;
+    run.exchange = EXCHANGE_BLOCKING;
+    run.keyType = KEY_INT;
+    run.compression = COMPRESS_OFF;
+    run.smallest = 0;
+    run.percentiles.clear (  );
+    run.groupBy = false;
+    run.phaseFile = NULL;
+    run.argsort = false;
+    run.columnBits.clear (  );
+
+    while ( ( option = getopt ( argc, argv, "ak:m:e:f:o:x:d:y:g:s:z:n:p:c:rl:" ) ) != -1 )
     {
-        swap = false;
-        for (size_t i = 0; i < a.size()-1; i++) 
+        switch ( option )
         {
-            if ( a[i]>a[i+1] )
-            {
-                a[i] += a[i+1];
-                a[i+1] = a[i] - a[i+1];
-                a[i] -=a[i+1];
-                swap = true;
-            }
+            case 'k':
+                if ( !parseSortKind ( optarg, run.sortKind ) )
+                    return false;
+                break;
+            case 'm':
+                exchangeGiven = true;
+                if ( strcmp ( optarg, "bucket" ) == 0 )
+                    run.mode = PARTITION_BUCKET;
+                else if ( strcmp ( optarg, "sample" ) == 0 )
+                    run.mode = PARTITION_SAMPLE;
+                else
+                    return false;
+                break;
+            case 'e':
+                exchangeGiven = true;
+                if ( strcmp ( optarg, "blocking" ) == 0 )
+                    run.exchange = EXCHANGE_BLOCKING;
+                else if ( strcmp ( optarg, "nonblocking" ) == 0 )
+                    run.exchange = EXCHANGE_NONBLOCKING;
+                else if ( strcmp ( optarg, "pipelined" ) == 0 )
+                    run.exchange = EXCHANGE_PIPELINED;
+                else
+                    return false;
+                break;
+            case 'f':
+                run.inputFile = optarg;
+                break;
+            case 'o':
+                run.outputFile = optarg;
+                break;
+            case 'x':
+                run.budget = atoi ( optarg );
+                if ( run.budget <= 0 )
+                    return false;
+                break;
+            case 'd':
+                run.spillDir = optarg;
+                break;
+            case 'g':
+                if ( !parseDistribution ( optarg, run.distribution ) )
+                    return false;
+                break;
+            case 's':
+                run.seed = strtoull ( optarg, NULL, 10 );
+                break;
+            case 'z':
+                exchangeGiven = true;
+                if ( !parseCompression ( optarg, run.compression ) )
+                    return false;
+                break;
+            case 'n':
+                run.smallest = atoi ( optarg );
+                if ( run.smallest <= 0 )
+                    return false;
+                break;
+            case 'a':
+                run.groupBy = true;
+                break;
+            case 'c':
+                run.phaseFile = optarg;
+                break;
+            case 'r':
+                run.argsort = true;
+                break;
+            case 'l':
+                if ( !parseColumnBits ( optarg, run.columnBits ) )
+                    return false;
+                run.argsort = true;
+                break;
+            case 'p':
+                if ( !parsePercentiles ( optarg, run.percentiles ) )
+                    return false;
+                break;
+            case 'y':
+                if ( strcmp ( optarg, "int" ) == 0 )
+                    run.keyType = KEY_INT;
+                else if ( strcmp ( optarg, "long" ) == 0 )
+                    run.keyType = KEY_LONG;
+                else if ( strcmp ( optarg, "float" ) == 0 )
+                    run.keyType = KEY_FLOAT;
+                else if ( strcmp ( optarg, "double" ) == 0 )
+                    run.keyType = KEY_DOUBLE;
+                else if ( strcmp ( optarg, "record" ) == 0 )
+                    run.keyType = KEY_RECORD;
+                else
+                    return false;
+                break;
+            default:
+                return false;
         }
     }
+
+    //Key files hold ints, and only int keys are bucketed by value, packed, selected or grouped
+    if ( run.keyType != KEY_INT )
+    {
+        if ( run.inputFile || run.outputFile || run.budget > 0 || run.distribution != DIST_UNIFORM ||
+             run.compression != COMPRESS_OFF || run.smallest > 0 || !run.percentiles.empty (  ) || run.groupBy )
+            return false;
+        run.mode = PARTITION_SAMPLE;
+    }
+
+    //Only buckets by value can be dealt out before anything is known about the other ranks' keys, and blocks go unpacked
+    if ( run.exchange == EXCHANGE_PIPELINED && ( run.mode != PARTITION_BUCKET || run.compression != COMPRESS_OFF ) )
+        return false;
+
+    //Grouping does one thing at a time, through the collective exchange, with unsorted groups that do not pack
+    if ( run.groupBy && ( run.smallest > 0 || !run.percentiles.empty (  ) || run.budget > 0 ||
+                          run.exchange == EXCHANGE_PIPELINED || run.compression != COMPRESS_OFF ) )
+        return false;
+
+    //Row numbers are sample sorted by radix sort, the only sort that keeps equal keys in order, and the columns are made up
+    if ( run.argsort )
+    {
+        if ( run.keyType != KEY_INT || run.budget > 0 || run.groupBy || run.smallest > 0 || !run.percentiles.empty (  ) ||
+             run.compression != COMPRESS_OFF || run.exchange == EXCHANGE_PIPELINED ||
+             ( run.sortKind != SORT_AUTO && run.sortKind != SORT_RADIX ) )
+            return false;
+        if ( !run.columnBits.empty (  ) && ( run.inputFile || run.distribution != DIST_UNIFORM ) )
+            return false;
+        run.mode = PARTITION_SAMPLE;
+        run.sortKind = SORT_RADIX;
+    }
+
+    //Only the sorts are split into phases
+    if ( run.phaseFile && ( run.groupBy || run.budget > 0 || run.smallest > 0 || !run.percentiles.empty (  ) ) )
+        return false;
+
+    //The external sort goes from file to file, with its own partitioning and no exchange
+    if ( run.budget > 0 && ( !run.inputFile || !run.outputFile || run.smallest > 0 || !run.percentiles.empty (  ) ||
+                             exchangeGiven ) )
+        return false;
+
+    //The keys come from the file or are made up, not both
+    if ( run.inputFile )
+        return argc == optind;
+
+    if ( argc - optind != 1 )
+        return false;
+
+    run.totalNums = atoll ( argv[optind] );
+
+    return run.totalNums > 0;
 }
@@ -0,0 +1,125 @@
+/** @file Exchange.cpp
+  * @brief The all-to-all under every exchange. Counts are 64 bit, and while every count and offset fits in an int
+  *        it is one MPI_Alltoallv or MPI_Ialltoallv. Past that MPI's int counts cannot say it, so every rank sends
+  *        and receives each bucket point to point in pieces of EXCHANGE_CHUNK instead.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Exchange.h"
+#include <string.h>
+#include <limits.h>
+
+using namespace std;
+
+ /**startExchange
+ *@fn void startExchange ( const void* sendBuffer, const vector<long long>& sendCounts, const vector<long long>& sendDispls, void* recvBuffer, const vector<long long>& recvCounts, const vector<long long>& recvDispls, MPI_Datatype type, int taskid, ExchangeMode exchange, PendingExchange& pending )
+ *@brief Starts sending bucket i of sendBuffer to rank i and receiving rank i's bucket into recvBuffer. The ranks agree
+ *       with one MPI_Allreduce whether any count or offset is too big for an int. If not this is MPI_Alltoallv, or
+ *       MPI_Ialltoallv when nonblocking. If so each bucket goes with MPI_Isend and MPI_Irecv in pieces of
+ *       EXCHANGE_CHUNK, which MPI keeps in order between any two ranks. The blocking exchange moves this rank's own
+ *       bucket too and is done when this returns, the others leave it to the caller. This is collective.
+ *@param sendBuffer The outgoing buckets
+ *@param sendCounts The size of each outgoing bucket
+ *@param sendDispls Where each outgoing bucket starts, in elements of type
+ *@param recvBuffer Where the incoming buckets go
+ *@param recvCounts The size of each incoming bucket
+ *@param recvDispls Where each incoming bucket goes, in elements of type
+ *@param type The MPI datatype of an element
+ *@param taskid This rank
+ *@param exchange Whether the exchange blocks
+ *@param pending Where what finishExchange needs is stored
+ *@return N/A
+ *@pre Every rank calls this with matching counts
+ *@post finishExchange ( pending ) completes the exchange
+ */
+void startExchange ( const void* sendBuffer, const vector<long long>& sendCounts, const vector<long long>& sendDispls,
+                     void* recvBuffer, const vector<long long>& recvCounts, const vector<long long>& recvDispls,
+                     MPI_Datatype type, int taskid, ExchangeMode exchange, PendingExchange& pending )
+{
+    int numRanks = sendCounts.size (  );
+
+    //Every rank has to take the same path
+    int large = 0;
+    for ( int i = 0; i < numRanks; i++ )
+    {
+        if ( sendDispls[i] + sendCounts[i] > INT_MAX || recvDispls[i] + recvCounts[i] > INT_MAX )
+            large = 1;
+    }
+    MPI_Allreduce ( MPI_IN_PLACE, &large, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD );
+
+    MPI_Aint lowerBound, extent;
+    MPI_Type_get_extent ( type, &lowerBound, &extent );
+
+    //Our own bucket counts too, so every destination's share is comparable
+    for ( int i = 0; i < numRanks; i++ )
+        countBytesSent ( i, sendCounts[i] * extent );
+
+    pending.requests.clear (  );
+
+    if ( !large )
+    {
+        pending.sendCounts.assign ( sendCounts.begin (  ), sendCounts.end (  ) );
+        pending.sendDispls.assign ( sendDispls.begin (  ), sendDispls.end (  ) );
+        pending.recvCounts.assign ( recvCounts.begin (  ), recvCounts.end (  ) );
+        pending.recvDispls.assign ( recvDispls.begin (  ), recvDispls.end (  ) );
+
+        if ( exchange == EXCHANGE_BLOCKING )
+        {
+            MPI_Alltoallv ( sendBuffer, pending.sendCounts.data (  ), pending.sendDispls.data (  ), type, recvBuffer,
+                            pending.recvCounts.data (  ), pending.recvDispls.data (  ), type, MPI_COMM_WORLD );
+            return;
+        }
+
+        pending.sendCounts[taskid] = 0;
+        pending.recvCounts[taskid] = 0;
+        pending.requests.resize ( 1 );
+
+        MPI_Ialltoallv ( sendBuffer, pending.sendCounts.data (  ), pending.sendDispls.data (  ), type, recvBuffer,
+                         pending.recvCounts.data (  ), pending.recvDispls.data (  ), type, MPI_COMM_WORLD, &pending.requests[0] );
+        return;
+    }
+
+    //Post every receive before the sends
+    for ( int i = 0; i < numRanks; i++ )
+    {
+        for ( long long at = 0; i != taskid && at < recvCounts[i]; at += EXCHANGE_CHUNK )
+        {
+            pending.requests.push_back ( MPI_REQUEST_NULL );
+            MPI_Irecv ( (char*)recvBuffer + ( recvDispls[i] + at ) * extent, min ( (long long)EXCHANGE_CHUNK, recvCounts[i] - at ),
+                        type, i, EXCHANGE_TAG, MPI_COMM_WORLD, &pending.requests.back (  ) );
+        }
+    }
+
+    for ( int i = 0; i < numRanks; i++ )
+    {
+        for ( long long at = 0; i != taskid && at < sendCounts[i]; at += EXCHANGE_CHUNK )
+        {
+            pending.requests.push_back ( MPI_REQUEST_NULL );
+            MPI_Isend ( (const char*)sendBuffer + ( sendDispls[i] + at ) * extent, min ( (long long)EXCHANGE_CHUNK, sendCounts[i] - at ),
+                        type, i, EXCHANGE_TAG, MPI_COMM_WORLD, &pending.requests.back (  ) );
+        }
+    }
+
+    if ( exchange == EXCHANGE_BLOCKING )
+    {
+        memcpy ( (char*)recvBuffer + recvDispls[taskid] * extent, (const char*)sendBuffer + sendDispls[taskid] * extent,
+                 sendCounts[taskid] * extent );
+        finishExchange ( pending );
+    }
+}
+
+ /**finishExchange
+ *@fn void finishExchange ( PendingExchange& pending )
+ *@brief Waits for an exchange from startExchange
+ *@param pending The exchange
+ *@return N/A
+ *@pre pending was filled in by startExchange
+ *@post Every bucket startExchange was asked to move has arrived
+ */
+void finishExchange ( PendingExchange& pending )
+{
+    MPI_Waitall ( pending.requests.size (  ), pending.requests.data (  ), MPI_STATUSES_IGNORE );
+    pending.requests.clear (  );
+}
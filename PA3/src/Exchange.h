@@ -0,0 +1,96 @@
+#ifndef EXCHANGE_H
+#define EXCHANGE_H
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include "mpi.h"
+#include "KeyTraits.h"
+#include "Phases.h"
+
+//How the buckets are moved between ranks
+enum ExchangeMode
+{
+    //One MPI_Alltoallv
+    EXCHANGE_BLOCKING,
+
+    //MPI_Ialltoallv for the other ranks' keys while this rank copies its own
+    EXCHANGE_NONBLOCKING,
+
+    //Blocks go out with MPI_Isend as they fill and are sorted as they arrive, bucket mode only, see Pipeline.h
+    EXCHANGE_PIPELINED
+};
+
+//Largest count handed to one MPI call, bigger buckets go in pieces
+#define EXCHANGE_CHUNK  ( 1 << 30 )
+
+//Tag of the pieces, the pipelined blocks use 1
+#define EXCHANGE_TAG    2
+
+//An exchange between startExchange and finishExchange. The int counts have to outlive a nonblocking collective.
+struct PendingExchange
+{
+    std::vector<int> sendCounts, sendDispls, recvCounts, recvDispls;
+    std::vector<MPI_Request> requests;
+};
+
+void startExchange ( const void* sendBuffer, const std::vector<long long>& sendCounts, const std::vector<long long>& sendDispls,
+                     void* recvBuffer, const std::vector<long long>& recvCounts, const std::vector<long long>& recvDispls,
+                     MPI_Datatype type, int taskid, ExchangeMode exchange, PendingExchange& pending );
+void finishExchange ( PendingExchange& pending );
+
+ /**exchangeBuckets
+ *@fn void exchangeBuckets ( const R* keys, const std::vector<long long>& sendCounts, int taskid, ExchangeMode exchange, std::vector<R>& bigBucket, std::vector<size_t>& runStarts )
+ *@brief Sends bucket i to rank i and gathers every rank's bucket for this rank into bigBucket. The bucket sizes are
+ *       swapped with MPI_Alltoall first so the big bucket is sized exactly, then the keys move through startExchange,
+ *       in one MPI_Alltoallv unless a count or offset is too big for an int. The nonblocking exchange leaves this
+ *       rank's own bucket out and copies it while the rest are in flight. Records go as their matching MPI datatype.
+ *       This is collective.
+ *@param keys This rank's buckets, back to back in rank order
+ *@param sendCounts The size of each bucket
+ *@param taskid This rank
+ *@param exchange Whether to use MPI_Alltoallv or MPI_Ialltoallv
+ *@param bigBucket Where the keys for this rank are stored
+ *@param runStarts Where the start of each received bucket in bigBucket is stored
+ *@return N/A
+ *@pre Every rank calls this with its own buckets
+ *@post bigBucket holds one run from each rank, in rank order
+ */
+template <typename R>
+void exchangeBuckets ( const R* keys, const std::vector<long long>& sendCounts, int taskid, ExchangeMode exchange,
+                       std::vector<R>& bigBucket, std::vector<size_t>& runStarts )
+{
+    int numBuckets = sendCounts.size (  );
+    std::vector<long long> recvCounts ( numBuckets ), sendDispls ( numBuckets ), recvDispls ( numBuckets );
+
+    //Find out how big each incoming bucket is
+    MPI_Alltoall ( sendCounts.data (  ), 1, MPI_LONG_LONG, recvCounts.data (  ), 1, MPI_LONG_LONG, MPI_COMM_WORLD );
+    endPhase ( PHASE_COUNTS );
+
+    //Turn the counts into where each bucket starts
+    long long sent = 0, received = 0;
+    runStarts.resize ( numBuckets );
+    for ( int i = 0; i < numBuckets; i++ )
+    {
+        sendDispls[i] = sent;
+        recvDispls[i] = received;
+        runStarts[i] = received;
+        sent += sendCounts[i];
+        received += recvCounts[i];
+    }
+
+    bigBucket.resize ( received );
+
+    PendingExchange pending;
+    startExchange ( keys, sendCounts, sendDispls, bigBucket.data (  ), recvCounts, recvDispls, RecordTraits<R>::datatype (  ),
+                    taskid, exchange, pending );
+
+    //Our own bucket does not need to go through MPI
+    if ( exchange != EXCHANGE_BLOCKING )
+        std::copy ( keys + sendDispls[taskid], keys + sendDispls[taskid] + sendCounts[taskid], bigBucket.begin (  ) + recvDispls[taskid] );
+
+    finishExchange ( pending );
+    endPhase ( PHASE_EXCHANGE );
+}
+
+#endif
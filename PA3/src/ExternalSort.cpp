@@ -0,0 +1,589 @@
+/** @file ExternalSort.cpp
+  * @brief An out-of-core bucket sort for key files bigger than the memory of every rank put together. The input is
+  *        streamed through in chunks, each chunk's keys are sent to the ranks that own them and spilled to bucket
+  *        files on local disk, and each bucket is then sorted in memory or, if it is still too big, merged from
+  *        sorted runs.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "ExternalSort.h"
+#include "KeyFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+#include <string>
+#include <queue>
+#include <algorithm>
+#include "mpi.h"
+
+using namespace std;
+
+//One bucket's spill file
+struct SpillFile
+{
+    int fd;
+    long long count;
+    string name;
+};
+
+static bool sampleSlice ( MPI_File input, long long first, long long count, vector<int>& samples );
+static void chooseSpillSplitters ( const int* keys, size_t n, int numRanks, vector<int>& splitters );
+static bool sendToOwners ( const int* outgoing, const vector<long long>& sendCounts, size_t chunkKeys,
+                           const vector<int>& splitters, int rank, vector<SpillFile>& spills );
+static bool spillKeys ( const int* keys, size_t n, const vector<int>& splitters, int firstBucket, vector<SpillFile>& spills );
+static bool sortBucket ( SpillFile& spill, MPI_File output, MPI_Offset offset, size_t budget, SortKind kind );
+static bool writeAll ( int fd, const void* data, size_t bytes );
+static bool readAll ( int fd, void* data, size_t bytes, off_t offset );
+
+ /**externalSort
+ *@fn bool externalSort ( const char* inputFile, const char* outputFile, const char* spillDir, size_t budget, SortKind kind, long long& totalNums )
+ *@brief Sorts a key file into another key file using at most about budget bytes of keys per rank. Splitters for
+ *       SPILL_BUCKETS buckets per rank come from keys read at even strides across every rank's slice. Each rank
+ *       then reads its slice of the input a chunk at a time, with the next chunk's read in flight while the current
+ *       one is sent to its owners and spilled, so the disk and the partitioning overlap. Last every rank sorts its
+ *       buckets in key order and writes them at its MPI_Exscan offset in the output. This is collective.
+ *@param inputFile The key file to sort
+ *@param outputFile Where the sorted key file is written
+ *@param spillDir The directory for spill files, which should be on local disk
+ *@param budget About how many bytes of keys each rank may hold at once
+ *@param kind How buckets are sorted
+ *@param totalNums Where the number of keys is stored
+ *@return false on every rank if a file could not be opened, read or written, or is not a key file as long as its count
+ *@pre Every rank calls this
+ *@post outputFile holds the keys of inputFile in ascending order and the spill files are gone
+ */
+bool externalSort ( const char* inputFile, const char* outputFile, const char* spillDir, size_t budget, SortKind kind,
+                    long long& totalNums )
+{
+    int rank, numRanks;
+    MPI_Comm_rank ( MPI_COMM_WORLD, &rank );
+    MPI_Comm_size ( MPI_COMM_WORLD, &numRanks );
+
+    //Two chunks in flight, the keys going out and at most a chunk coming in all fit in the budget, and a chunk in one MPI read
+    size_t chunkKeys = std::min ( std::max ( budget / ( 4 * sizeof ( int ) ), (size_t)1024 ), (size_t)IO_CHUNK );
+
+    MPI_File input;
+    KeyFileHeader header;
+
+    if ( MPI_File_open ( MPI_COMM_WORLD, inputFile, MPI_MODE_RDONLY, MPI_INFO_NULL, &input ) != MPI_SUCCESS )
+        return false;
+
+    if ( !readKeyFileHeader ( input, header ) )
+    {
+        MPI_File_close ( &input );
+        return false;
+    }
+
+    totalNums = header.count;
+
+    //This rank's slice and how many chunks it takes, every rank goes round as often as the busiest one
+    long long first = totalNums * rank / numRanks;
+    long long last = totalNums * ( rank + 1 ) / numRanks;
+    long long myRounds = ( last - first + chunkKeys - 1 ) / chunkKeys, rounds;
+    MPI_Allreduce ( &myRounds, &rounds, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD );
+
+    //Sample the whole slice, not just its start, so sorted or drifting input still spreads over the buckets
+    vector<int> samples, splitters;
+    int spilled = sampleSlice ( input, first, last - first, samples ), allSpilled;
+    chooseSpillSplitters ( samples.data (  ), samples.size (  ), numRanks, splitters );
+    vector<int> (  ).swap ( samples );
+
+    //Open this rank's spill files
+    vector<SpillFile> spills ( SPILL_BUCKETS );
+    int opened = 1, allOpened;
+    for ( int i = 0; i < SPILL_BUCKETS; i++ )
+    {
+        spills[i].name = string ( spillDir ) + "/spill." + to_string ( getpid (  ) ) + "." + to_string ( rank ) + "." + to_string ( i );
+        spills[i].fd = open ( spills[i].name.c_str (  ), O_RDWR | O_CREAT | O_TRUNC, 0600 );
+        spills[i].count = 0;
+        if ( spills[i].fd < 0 )
+            opened = 0;
+    }
+
+    MPI_Allreduce ( &opened, &allOpened, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD );
+
+    if ( !allOpened )
+    {
+        for ( int i = 0; i < SPILL_BUCKETS; i++ )
+        {
+            if ( spills[i].fd >= 0 )
+            {
+                close ( spills[i].fd );
+                unlink ( spills[i].name.c_str (  ) );
+            }
+        }
+        MPI_File_close ( &input );
+        return false;
+    }
+
+    //Double buffered reads: chunk r is read into buffer r % 2
+    vector<int> buffers[2] = { vector<int> ( chunkKeys ), vector<int> ( chunkKeys ) };
+    MPI_Request reads[2];
+    size_t lengths[2];
+
+    for ( long long round = 0; round < 2; round++ )
+    {
+        long long start = first + round * chunkKeys;
+        lengths[round] = round < myRounds ? std::min ( (long long)chunkKeys, last - start ) : 0;
+        reads[round] = MPI_REQUEST_NULL;
+        if ( lengths[round] > 0 )
+            MPI_File_iread_at ( input, sizeof ( header ) + start * sizeof ( int ), buffers[round].data (  ), lengths[round],
+                                MPI_INT, &reads[round] );
+    }
+
+    vector<int> outgoing, owners;
+
+    for ( long long round = 0; round < rounds; round++ )
+    {
+        int current = round % 2;
+        MPI_Status status;
+        MPI_Wait ( &reads[current], &status );
+
+        //A short read fails the sort like a failed spill
+        int got;
+        if ( lengths[current] > 0 && ( MPI_Get_count ( &status, MPI_INT, &got ) != MPI_SUCCESS || (size_t)got != lengths[current] ) )
+            spilled = 0;
+
+        const int* keys = buffers[current].data (  );
+        size_t n = lengths[current];
+
+        //Send each key to the rank that owns its bucket
+        vector<long long> sendCounts ( numRanks, 0 );
+        owners.resize ( n );
+        for ( size_t i = 0; i < n; i++ )
+        {
+            owners[i] = ( upper_bound ( splitters.begin (  ), splitters.end (  ), keys[i] ) - splitters.begin (  ) ) / SPILL_BUCKETS;
+            sendCounts[owners[i]]++;
+        }
+
+        vector<long long> next ( numRanks, 0 );
+        for ( int i = 1; i < numRanks; i++ )
+            next[i] = next[i - 1] + sendCounts[i - 1];
+
+        outgoing.resize ( n );
+        for ( size_t i = 0; i < n; i++ )
+            outgoing[next[owners[i]]++] = keys[i];
+
+        //The buffer is free again, start reading the chunk after next into it
+        long long ahead = round + 2;
+        long long start = first + ahead * chunkKeys;
+        lengths[current] = ahead < myRounds ? std::min ( (long long)chunkKeys, last - start ) : 0;
+        if ( lengths[current] > 0 )
+            MPI_File_iread_at ( input, sizeof ( header ) + start * sizeof ( int ), buffers[current].data (  ), lengths[current],
+                                MPI_INT, &reads[current] );
+
+        if ( !sendToOwners ( outgoing.data (  ), sendCounts, chunkKeys, splitters, rank, spills ) )
+            spilled = 0;
+    }
+
+    MPI_File_close ( &input );
+
+    //Give up everywhere if any rank could not read or spill
+    MPI_Allreduce ( &spilled, &allSpilled, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD );
+
+    //Free the chunk buffers before the buckets are sorted
+    vector<int> (  ).swap ( buffers[0] );
+    vector<int> (  ).swap ( buffers[1] );
+    vector<int> (  ).swap ( outgoing );
+    vector<int> (  ).swap ( owners );
+
+    //Where this rank's keys go in the output
+    long long myNums = 0, before = 0;
+    for ( int i = 0; i < SPILL_BUCKETS; i++ )
+        myNums += spills[i].count;
+
+    MPI_Exscan ( &myNums, &before, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+    if ( rank == 0 )
+        before = 0;
+
+    MPI_File output;
+    bool written = allSpilled && MPI_File_open ( MPI_COMM_WORLD, outputFile, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &output ) == MPI_SUCCESS;
+
+    //Whether this rank's share of the output made it to the file
+    int sorted = 1;
+
+    if ( written )
+    {
+        sorted = MPI_File_set_size ( output, sizeof ( header ) + totalNums * sizeof ( int ) ) == MPI_SUCCESS;
+
+        //Rank 0 writes the header, everyone else joins in with nothing
+        MPI_Status status;
+        int headerBytes = rank == 0 ? sizeof ( header ) : 0, got;
+        sorted = MPI_File_write_at_all ( output, 0, &header, headerBytes, MPI_BYTE, &status ) == MPI_SUCCESS &&
+                 MPI_Get_count ( &status, MPI_BYTE, &got ) == MPI_SUCCESS && got == headerBytes && sorted;
+    }
+
+    //Sort each bucket in order and write it after the one before, stopping at the first failure
+    MPI_Offset offset = sizeof ( header ) + before * sizeof ( int );
+    for ( int i = 0; i < SPILL_BUCKETS; i++ )
+    {
+        if ( written && sorted )
+            sorted = sortBucket ( spills[i], output, offset, budget, kind );
+
+        offset += spills[i].count * sizeof ( int );
+        close ( spills[i].fd );
+        unlink ( spills[i].name.c_str (  ) );
+    }
+
+    if ( written )
+        sorted = MPI_File_close ( &output ) == MPI_SUCCESS && sorted;
+
+    //Give up everywhere if any rank could not sort its buckets into the output
+    MPI_Allreduce ( MPI_IN_PLACE, &sorted, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD );
+
+    return written && sorted;
+}
+
+ /**sampleSlice
+ *@fn bool sampleSlice ( MPI_File input, long long first, long long count, vector<int>& samples )
+ *@brief Reads OVERSAMPLE * SPILL_BUCKETS keys at an even stride across this rank's slice in one read through a strided
+ *       file view, then puts the view back to bytes. This is collective.
+ *@param input The key file
+ *@param first The slice's first key
+ *@param count The number of keys in the slice
+ *@param samples Where the keys read are stored
+ *@return false if the read failed or came up short
+ *@pre No other read of input is in flight
+ *@post samples holds the keys, and the view of input is the default one
+ */
+static bool sampleSlice ( MPI_File input, long long first, long long count, vector<int>& samples )
+{
+    long long numSamples = std::min ( count, (long long)OVERSAMPLE * SPILL_BUCKETS );
+    long long stride = numSamples > 0 ? count / numSamples : 1;
+    samples.resize ( numSamples );
+
+    //One key every stride keys, an empty slice still needs a type to join in with
+    MPI_Datatype strided;
+    MPI_Type_create_hvector ( std::max ( numSamples, 1LL ), 1, stride * sizeof ( int ), MPI_INT, &strided );
+    MPI_Type_commit ( &strided );
+
+    //The read is independent, a collective one has an aggregator allocate a buffer far bigger than the samples
+    MPI_Status status;
+    int got = 0;
+    bool read = MPI_File_set_view ( input, sizeof ( KeyFileHeader ) + first * sizeof ( int ), MPI_INT, strided, "native",
+                                    MPI_INFO_NULL ) == MPI_SUCCESS &&
+                MPI_File_read ( input, samples.data (  ), numSamples, MPI_INT, &status ) == MPI_SUCCESS &&
+                MPI_Get_count ( &status, MPI_INT, &got ) == MPI_SUCCESS && got == numSamples;
+
+    read = MPI_File_set_view ( input, 0, MPI_BYTE, MPI_BYTE, "native", MPI_INFO_NULL ) == MPI_SUCCESS && read;
+    MPI_Type_free ( &strided );
+
+    return read;
+}
+
+ /**chooseSpillSplitters
+ *@fn void chooseSpillSplitters ( const int* keys, size_t n, int numRanks, vector<int>& splitters )
+ *@brief Every rank takes OVERSAMPLE * SPILL_BUCKETS evenly spaced keys from its chunk, the samples are allgathered and
+ *       sorted, and every OVERSAMPLE-th one becomes a splitter. This is collective.
+ *@param keys Keys sampled from this rank's slice
+ *@param n The number of keys in it
+ *@param numRanks The number of ranks
+ *@param splitters Where the numRanks * SPILL_BUCKETS - 1 splitters are stored
+ *@return N/A
+ *@pre Every rank calls this
+ *@post splitters is the same on every rank and in ascending order
+ */
+static void chooseSpillSplitters ( const int* keys, size_t n, int numRanks, vector<int>& splitters )
+{
+    int numSamples = n > 0 ? OVERSAMPLE * SPILL_BUCKETS : 0;
+    vector<int> samples ( numSamples ), counts ( numRanks ), displacements ( numRanks );
+
+    for ( int i = 0; i < numSamples; i++ )
+        samples[i] = keys[n * i / numSamples];
+
+    //Ranks without keys send no samples
+    MPI_Allgather ( &numSamples, 1, MPI_INT, counts.data (  ), 1, MPI_INT, MPI_COMM_WORLD );
+
+    int total = 0;
+    for ( int i = 0; i < numRanks; i++ )
+    {
+        displacements[i] = total;
+        total += counts[i];
+    }
+
+    vector<int> allSamples ( total );
+    MPI_Allgatherv ( samples.data (  ), numSamples, MPI_INT, allSamples.data (  ), counts.data (  ), displacements.data (  ),
+                     MPI_INT, MPI_COMM_WORLD );
+
+    sort ( allSamples.begin (  ), allSamples.end (  ) );
+
+    int numBuckets = numRanks * SPILL_BUCKETS;
+    splitters.assign ( numBuckets - 1, 0 );
+    for ( int i = 1; total > 0 && i < numBuckets; i++ )
+        splitters[i - 1] = allSamples[(long long)total * i / numBuckets];
+}
+
+ /**sendToOwners
+ *@fn bool sendToOwners ( const int* outgoing, const vector<long long>& sendCounts, size_t chunkKeys, const vector<int>& splitters, int rank, vector<SpillFile>& spills )
+ *@brief Sends each rank its keys and spills what arrives, with no rank taking in more than chunkKeys keys at once. The
+ *       counts are swapped first. The keys coming to a rank are lined up in sender order, and each MPI_Alltoallv moves
+ *       the next chunkKeys of that line, so skewed or sorted input costs more exchanges instead of more memory on the
+ *       owner. This is collective.
+ *@param outgoing This rank's keys, grouped by owner in rank order
+ *@param sendCounts How many keys go to each rank
+ *@param chunkKeys The most keys a rank takes in per exchange
+ *@param splitters The splitters
+ *@param rank This rank
+ *@param spills This rank's spill files
+ *@return false if a spill file could not be written
+ *@pre Every rank calls this
+ *@post The keys this rank owns are on the end of their spill files if true is returned
+ */
+static bool sendToOwners ( const int* outgoing, const vector<long long>& sendCounts, size_t chunkKeys,
+                           const vector<int>& splitters, int rank, vector<SpillFile>& spills )
+{
+    int numRanks = sendCounts.size (  );
+    vector<long long> recvCounts ( numRanks ), sendStarts ( numRanks, 0 ), recvStarts ( numRanks, 0 ), outStarts ( numRanks, 0 );
+    MPI_Alltoall ( sendCounts.data (  ), 1, MPI_LONG_LONG, recvCounts.data (  ), 1, MPI_LONG_LONG, MPI_COMM_WORLD );
+
+    //Where this rank's keys start in each owner's line, after those of the ranks before it
+    MPI_Exscan ( sendCounts.data (  ), sendStarts.data (  ), numRanks, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+    if ( rank == 0 )
+        fill ( sendStarts.begin (  ), sendStarts.end (  ), 0 );
+
+    for ( int i = 1; i < numRanks; i++ )
+    {
+        recvStarts[i] = recvStarts[i - 1] + recvCounts[i - 1];
+        outStarts[i] = outStarts[i - 1] + sendCounts[i - 1];
+    }
+
+    //Every rank goes round as often as the busiest owner needs
+    long long myExchanges = ( recvStarts[numRanks - 1] + recvCounts[numRanks - 1] + chunkKeys - 1 ) / chunkKeys, exchanges;
+    MPI_Allreduce ( &myExchanges, &exchanges, 1, MPI_LONG_LONG, MPI_MAX, MPI_COMM_WORLD );
+
+    vector<int> incoming, counts ( numRanks ), displacements ( numRanks ), inCounts ( numRanks ), inDisplacements ( numRanks );
+    bool spilled = true;
+
+    for ( long long exchange = 0; exchange < exchanges; exchange++ )
+    {
+        long long low = exchange * chunkKeys, high = low + chunkKeys;
+        int received = 0;
+
+        //Each rank's part of the line that falls in this exchange, going out and coming in
+        for ( int i = 0; i < numRanks; i++ )
+        {
+            long long from = std::max ( sendStarts[i], low ), to = std::min ( sendStarts[i] + sendCounts[i], high );
+            counts[i] = std::max ( to - from, 0LL );
+            displacements[i] = outStarts[i] + from - sendStarts[i];
+
+            from = std::max ( recvStarts[i], low );
+            to = std::min ( recvStarts[i] + recvCounts[i], high );
+            inCounts[i] = std::max ( to - from, 0LL );
+            inDisplacements[i] = received;
+            received += inCounts[i];
+        }
+
+        incoming.resize ( received );
+        MPI_Alltoallv ( outgoing, counts.data (  ), displacements.data (  ), MPI_INT, incoming.data (  ), inCounts.data (  ),
+                        inDisplacements.data (  ), MPI_INT, MPI_COMM_WORLD );
+
+        if ( spilled && !spillKeys ( incoming.data (  ), incoming.size (  ), splitters, rank * SPILL_BUCKETS, spills ) )
+            spilled = false;
+    }
+
+    return spilled;
+}
+
+ /**spillKeys
+ *@fn bool spillKeys ( const int* keys, size_t n, const vector<int>& splitters, int firstBucket, vector<SpillFile>& spills )
+ *@brief Groups keys by bucket with a counting pass and appends each group to its spill file in one write
+ *@param keys Keys owned by this rank
+ *@param n The number of keys
+ *@param splitters The splitters
+ *@param firstBucket The first bucket this rank owns
+ *@param spills This rank's spill files
+ *@return false if a spill file could not be written, the disk is probably full
+ *@pre Every key belongs to one of this rank's buckets
+ *@post The keys are on the end of their spill files
+ */
+static bool spillKeys ( const int* keys, size_t n, const vector<int>& splitters, int firstBucket, vector<SpillFile>& spills )
+{
+    vector<int> buckets ( n );
+    vector<size_t> next ( SPILL_BUCKETS + 1, 0 );
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        buckets[i] = ( upper_bound ( splitters.begin (  ), splitters.end (  ), keys[i] ) - splitters.begin (  ) ) - firstBucket;
+        next[buckets[i] + 1]++;
+    }
+
+    for ( int i = 0; i < SPILL_BUCKETS; i++ )
+        next[i + 1] += next[i];
+
+    vector<int> grouped ( n );
+    vector<size_t> starts ( next );
+    for ( size_t i = 0; i < n; i++ )
+        grouped[next[buckets[i]]++] = keys[i];
+
+    for ( int i = 0; i < SPILL_BUCKETS; i++ )
+    {
+        size_t count = starts[i + 1] - starts[i];
+        if ( count > 0 && !writeAll ( spills[i].fd, &grouped[starts[i]], count * sizeof ( int ) ) )
+            return false;
+        spills[i].count += count;
+    }
+
+    return true;
+}
+
+ /**sortBucket
+ *@fn bool sortBucket ( SpillFile& spill, MPI_File output, MPI_Offset offset, size_t budget, SortKind kind )
+ *@brief Sorts one spill file into the output. A bucket that fits in half the budget is read, sorted and written in one
+ *       go. A bigger one is cut into sorted runs of that size, which are then merged through a heap with a read buffer
+ *       per run.
+ *@param spill The bucket
+ *@param output The output file
+ *@param offset Where the bucket goes in the output
+ *@param budget About how many bytes of keys this rank may hold at once
+ *@param kind How keys are sorted in memory
+ *@return false if a read or write of the spill file or the output failed or came up short
+ *@pre N/A
+ *@post The bucket's keys are in the output in ascending order if true is returned
+ */
+static bool sortBucket ( SpillFile& spill, MPI_File output, MPI_Offset offset, size_t budget, SortKind kind )
+{
+    //Radix sort needs as much again for scratch, and a run has to fit in one MPI write
+    size_t runKeys = std::min ( std::max ( budget / ( 2 * sizeof ( int ) ), (size_t)1024 ), (size_t)IO_CHUNK );
+
+    if ( spill.count == 0 )
+        return true;
+
+    if ( (size_t)spill.count <= runKeys )
+    {
+        vector<int> keys ( spill.count );
+        if ( !readAll ( spill.fd, keys.data (  ), spill.count * sizeof ( int ), 0 ) )
+            return false;
+        localSort ( keys, kind );
+        return writeAt ( output, offset, keys.data (  ), keys.size (  ), MPI_INT );
+    }
+
+    //Sort each run where it is in the spill file
+    int numRuns = ( spill.count + runKeys - 1 ) / runKeys;
+    vector<int> keys ( runKeys );
+    for ( int run = 0; run < numRuns; run++ )
+    {
+        off_t start = (off_t)run * runKeys;
+        size_t n = std::min ( (long long)runKeys, spill.count - start );
+
+        if ( !readAll ( spill.fd, keys.data (  ), n * sizeof ( int ), start * sizeof ( int ) ) )
+            return false;
+        localSort ( keys.data (  ), n, kind );
+        if ( lseek ( spill.fd, start * sizeof ( int ), SEEK_SET ) < 0 || !writeAll ( spill.fd, keys.data (  ), n * sizeof ( int ) ) )
+            return false;
+    }
+    vector<int> (  ).swap ( keys );
+
+    //A read buffer per run and one for the output share the budget
+    size_t bufferKeys = std::max ( runKeys / ( numRuns + 1 ), (size_t)256 );
+    vector<int> buffers ( (size_t)numRuns * bufferKeys ), out ( bufferKeys );
+    vector<size_t> positions ( numRuns ), lengths ( numRuns );
+    vector<long long> consumed ( numRuns, 0 );
+
+    //The smallest key at the front of each run
+    priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > heap;
+
+    for ( int run = 0; run < numRuns; run++ )
+    {
+        long long runLength = std::min ( (long long)runKeys, spill.count - run * (long long)runKeys );
+        lengths[run] = std::min ( (long long)bufferKeys, runLength );
+        positions[run] = 0;
+        if ( !readAll ( spill.fd, &buffers[run * bufferKeys], lengths[run] * sizeof ( int ), (off_t)run * runKeys * sizeof ( int ) ) )
+            return false;
+        consumed[run] = lengths[run];
+        heap.push ( make_pair ( buffers[run * bufferKeys], run ) );
+    }
+
+    size_t filled = 0;
+    while ( !heap.empty (  ) )
+    {
+        int run = heap.top (  ).second;
+        out[filled++] = heap.top (  ).first;
+        heap.pop (  );
+
+        if ( filled == bufferKeys )
+        {
+            if ( !writeAt ( output, offset, out.data (  ), filled, MPI_INT ) )
+                return false;
+            offset += filled * sizeof ( int );
+            filled = 0;
+        }
+
+        //Refill the run's buffer when it runs dry
+        if ( ++positions[run] == lengths[run] )
+        {
+            long long runLength = std::min ( (long long)runKeys, spill.count - run * (long long)runKeys );
+            lengths[run] = std::min ( (long long)bufferKeys, runLength - consumed[run] );
+            positions[run] = 0;
+
+            if ( lengths[run] == 0 )
+                continue;
+
+            if ( !readAll ( spill.fd, &buffers[run * bufferKeys], lengths[run] * sizeof ( int ),
+                            ( (off_t)run * runKeys + consumed[run] ) * sizeof ( int ) ) )
+                return false;
+            consumed[run] += lengths[run];
+        }
+
+        heap.push ( make_pair ( buffers[run * bufferKeys + positions[run]], run ) );
+    }
+
+    return writeAt ( output, offset, out.data (  ), filled, MPI_INT );
+}
+
+ /**writeAll
+ *@fn bool writeAll ( int fd, const void* data, size_t bytes )
+ *@brief Writes every byte, going round again on a short write
+ *@param fd The file
+ *@param data The bytes
+ *@param bytes How many
+ *@return false if the write failed
+ *@pre N/A
+ *@post The bytes are written at the file position
+ */
+static bool writeAll ( int fd, const void* data, size_t bytes )
+{
+    const char* from = (const char*)data;
+
+    while ( bytes > 0 )
+    {
+        ssize_t done = write ( fd, from, bytes );
+        if ( done <= 0 )
+            return false;
+        from += done;
+        bytes -= done;
+    }
+
+    return true;
+}
+
+ /**readAll
+ *@fn bool readAll ( int fd, void* data, size_t bytes, off_t offset )
+ *@brief Reads every byte from an offset, going round again on a short read
+ *@param fd The file
+ *@param data Where the bytes go
+ *@param bytes How many
+ *@param offset Where in the file
+ *@return false if the read failed or hit the end
+ *@pre N/A
+ *@post data holds the bytes
+ */
+static bool readAll ( int fd, void* data, size_t bytes, off_t offset )
+{
+    char* to = (char*)data;
+
+    while ( bytes > 0 )
+    {
+        ssize_t done = pread ( fd, to, bytes, offset );
+        if ( done <= 0 )
+            return false;
+        to += done;
+        bytes -= done;
+        offset += done;
+    }
+
+    return true;
+}
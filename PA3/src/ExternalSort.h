@@ -0,0 +1,16 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <cstddef>
+#include "LocalSort.h"
+
+//Spill files, and so buckets, per rank
+#define SPILL_BUCKETS   64
+
+//Samples taken per splitter
+#define OVERSAMPLE      8
+
+bool externalSort ( const char* inputFile, const char* outputFile, const char* spillDir, size_t budget, SortKind kind,
+                    long long& totalNums );
+
+#endif
@@ -0,0 +1,116 @@
+/** @file Generator.cpp
+  * @brief Writes made up keys to a binary key file for Sequential and Dynamic to read with -f. Run under mpirun every
+  *        rank makes and writes its own slice, and the file is the same whatever the number of ranks.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.1
+  */
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+#include <unistd.h>
+#include "mpi.h"
+#include "KeyFile.h"
+#include "Random.h"
+
+#define MASTER      0
+
+using namespace std;
+
+//What the command line asked for
+struct RunOptions
+{
+    long long totalNums;
+    const char* fileName;
+
+    //One more than the largest key
+    int max;
+
+    Distribution distribution;
+    unsigned long long seed;
+};
+
+bool parseArguments ( int argc, char** argv, RunOptions& run );
+
+int main ( int argc, char** argv )
+{
+    RunOptions run;
+    bool parsed = parseArguments ( argc, argv, run );
+    int numRanks, taskid;
+
+    MPI_Init ( &argc, &argv );
+    MPI_Comm_size ( MPI_COMM_WORLD, &numRanks );
+    MPI_Comm_rank ( MPI_COMM_WORLD, &taskid );
+
+    if ( !parsed )
+    {
+        if ( taskid == MASTER )
+            cerr << "Usage: " << argv[0] << " [-g uniform|zipf|gaussian|sorted|reverse|few|equal] [-s seed] totalNums fileName [max]" << endl;
+        MPI_Finalize (  );
+        return 1;
+    }
+
+    //Make up this rank's slice
+    long long first, count;
+    sliceOf ( run.totalNums, numRanks, taskid, first, count );
+
+    vector<int> keys ( count );
+    generateKeys ( keys.data (  ), first, count, run.totalNums, run.max, run.distribution, run.seed );
+
+    bool written = writeKeyFileAll ( run.fileName, MPI_COMM_WORLD, keys.data (  ), count );
+
+    if ( !written && taskid == MASTER )
+        cerr << "Could not write " << run.fileName << endl;
+
+    MPI_Finalize (  );
+
+    return written ? 0 : 1;
+}
+
+ /**parseArguments
+ *@fn bool parseArguments ( int argc, char** argv, RunOptions& run )
+ *@brief Reads [-g distribution] [-s seed] totalNums fileName [max]
+ *@param argc The argument count
+ *@param argv The arguments
+ *@param run Where the options are stored
+ *@return false if the arguments are not understood
+ *@pre N/A
+ *@post run is filled in if true is returned, uniform keys below 100000 from DEFAULT_SEED unless asked for, the same
+ *      range the programs make up themselves
+ */
+bool parseArguments ( int argc, char** argv, RunOptions& run )
+{
+    int option;
+
+    run.max = 100000;
+    run.distribution = DIST_UNIFORM;
+    run.seed = DEFAULT_SEED;
+
+    while ( ( option = getopt ( argc, argv, "g:s:" ) ) != -1 )
+    {
+        switch ( option )
+        {
+            case 'g':
+                if ( !parseDistribution ( optarg, run.distribution ) )
+                    return false;
+                break;
+            case 's':
+                run.seed = strtoull ( optarg, NULL, 10 );
+                break;
+            default:
+                return false;
+        }
+    }
+
+    int positional = argc - optind;
+    if ( positional < 2 || positional > 3 )
+        return false;
+
+    run.totalNums = atoll ( argv[optind] );
+    run.fileName = argv[optind + 1];
+    if ( positional == 3 )
+        run.max = atoi ( argv[optind + 2] );
+
+    return run.totalNums > 0 && run.max > 0;
+}
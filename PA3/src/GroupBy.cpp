@@ -0,0 +1,363 @@
+/** @file GroupBy.cpp
+  * @brief Group by key over every rank. Each rank first combines its own rows into one group per key, then the groups
+  *        are dealt out by a hash of the key over the same exchange the sort uses, and every rank merges the groups
+  *        it owns. Only one partial group per key per rank crosses the network, however many rows it had. When the
+  *        keys hardly repeat a partial group is bigger than the row it stands for, and the rows go instead.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "GroupBy.h"
+#include "Partition.h"
+#include "Random.h"
+#include "KeyFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+static Aggregate& findGroup ( GroupTable& table, int key );
+static void growTable ( GroupTable& table );
+template <typename R> void exchangeByHash ( const R* records, size_t n, int taskid, ExchangeMode exchange, vector<R>& received, size_t& longest );
+
+ /**makeValues
+ *@fn void makeValues ( int* values, long long first, size_t n, unsigned long long seed )
+ *@brief Makes up the value of each row from its row number and the seed, from 0 to VALUE_RANGE - 1, so the same
+ *       rows get the same values for any number of ranks
+ *@param values Where the values are stored
+ *@param first The row number of the first value
+ *@param n The number of values
+ *@param seed The seed
+ *@return N/A
+ *@pre values holds n ints
+ *@post values is filled in
+ */
+void makeValues ( int* values, long long first, size_t n, unsigned long long seed )
+{
+    for ( size_t i = 0; i < n; i++ )
+    {
+        //The last word, the keys use the first two
+        unsigned int bits[4];
+        philox ( first + i, seed, bits );
+        values[i] = ( (unsigned long long)bits[3] * VALUE_RANGE ) >> 32;
+    }
+}
+
+ /**initGroupTable
+ *@fn void initGroupTable ( GroupTable& table, size_t groups )
+ *@brief Empties a table and sizes it for some number of groups
+ *@param table The table
+ *@param groups How many groups are expected
+ *@return N/A
+ *@pre N/A
+ *@post table is empty with at least twice groups slots, and GROUP_TABLE_MIN at least
+ */
+void initGroupTable ( GroupTable& table, size_t groups )
+{
+    size_t size = GROUP_TABLE_MIN;
+    while ( size < 2 * groups )
+        size *= 2;
+
+    table.slots.assign ( size, Aggregate (  ) );
+    table.used = 0;
+}
+
+ /**addRows
+ *@fn void addRows ( GroupTable& table, const int* keys, const int* values, size_t n )
+ *@brief Adds rows to their groups
+ *@param table The table
+ *@param keys The key of each row
+ *@param values The value of each row
+ *@param n The number of rows
+ *@return N/A
+ *@pre table was set up by initGroupTable
+ *@post Every row is counted in its key's group
+ */
+void addRows ( GroupTable& table, const int* keys, const int* values, size_t n )
+{
+    for ( size_t i = 0; i < n; i++ )
+    {
+        Aggregate& group = findGroup ( table, keys[i] );
+        group.count++;
+        group.sum += values[i];
+        group.min = min ( group.min, values[i] );
+        group.max = max ( group.max, values[i] );
+    }
+}
+
+ /**addGroups
+ *@fn void addGroups ( GroupTable& table, const Aggregate* groups, size_t n )
+ *@brief Merges partial groups into the groups of the same key
+ *@param table The table
+ *@param groups The partial groups
+ *@param n The number of partial groups
+ *@return N/A
+ *@pre table was set up by initGroupTable
+ *@post Every partial group is merged into its key's group
+ */
+void addGroups ( GroupTable& table, const Aggregate* groups, size_t n )
+{
+    for ( size_t i = 0; i < n; i++ )
+    {
+        Aggregate& group = findGroup ( table, groups[i].key );
+        group.count += groups[i].count;
+        group.sum += groups[i].sum;
+        group.min = min ( group.min, groups[i].min );
+        group.max = max ( group.max, groups[i].max );
+    }
+}
+
+ /**tableGroups
+ *@fn void tableGroups ( const GroupTable& table, vector<Aggregate>& groups )
+ *@brief Copies the groups out of a table
+ *@param table The table
+ *@param groups Where the groups are stored
+ *@return N/A
+ *@pre N/A
+ *@post groups holds every group in the table, in slot order
+ */
+void tableGroups ( const GroupTable& table, vector<Aggregate>& groups )
+{
+    groups.clear (  );
+    groups.reserve ( table.used );
+
+    for ( size_t slot = 0; slot < table.slots.size (  ); slot++ )
+    {
+        if ( table.slots[slot].count > 0 )
+            groups.push_back ( table.slots[slot] );
+    }
+}
+
+ /**groupBy
+ *@fn void groupBy ( const int* keys, const int* values, size_t n, int taskid, ExchangeMode exchange, vector<Aggregate>& groups, long long& sentBytes, long long& rowBytes )
+ *@brief Groups every rank's rows by key. The rows are combined into a table on their own rank, and if the partial
+ *       groups add up to fewer bytes over every rank than the rows would, they are exchanged by the hash of their key
+ *       and each rank merges what it receives into a second table. Otherwise the rows themselves are exchanged and
+ *       added up on arrival. This is collective.
+ *@param keys The key of each of this rank's rows
+ *@param values The value of each row
+ *@param n The number of rows
+ *@param taskid This rank
+ *@param exchange Whether to use MPI_Alltoallv or MPI_Ialltoallv
+ *@param groups Where the groups this rank owns are stored
+ *@param sentBytes Where the bytes this rank sent to other ranks are stored
+ *@param rowBytes Where the bytes the rows alone would have taken are stored
+ *@return N/A
+ *@pre Every rank calls this with its own rows and exchange is not EXCHANGE_PIPELINED
+ *@post Every key is in the groups of exactly one rank, with the count, sum, min and max over every rank's rows
+ */
+void groupBy ( const int* keys, const int* values, size_t n, int taskid, ExchangeMode exchange,
+               vector<Aggregate>& groups, long long& sentBytes, long long& rowBytes )
+{
+    int numRanks;
+    MPI_Comm_size ( MPI_COMM_WORLD, &numRanks );
+    HashBuckets bucketOf = { numRanks };
+
+    //Combine this rank's rows first
+    GroupTable table;
+    vector<Aggregate> combined;
+    initGroupTable ( table, 0 );
+    addRows ( table, keys, values, n );
+    tableGroups ( table, combined );
+
+    //What each way would send, only what crosses the network counts
+    long long bytes[2] = { 0, 0 };
+    for ( size_t i = 0; i < combined.size (  ); i++ )
+    {
+        if ( bucketOf ( combined[i] ) != taskid )
+        {
+            bytes[0] += sizeof ( Aggregate );
+            bytes[1] += combined[i].count * sizeof ( GroupRow );
+        }
+    }
+    long long totals[2];
+    MPI_Allreduce ( bytes, totals, 2, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD );
+    rowBytes = bytes[1];
+
+    //The second table starts out sized for the longest run received. The groups in one run all have different keys,
+    //and rows only go when their keys hardly repeat.
+    size_t longest;
+
+    if ( totals[0] <= totals[1] )
+    {
+        vector<Aggregate> received;
+        exchangeByHash ( combined.data (  ), combined.size (  ), taskid, exchange, received, longest );
+        sentBytes = bytes[0];
+
+        initGroupTable ( table, longest );
+        addGroups ( table, received.data (  ), received.size (  ) );
+    }
+    else
+    {
+        vector<GroupRow> rows ( n ), received;
+        for ( size_t i = 0; i < n; i++ )
+        {
+            rows[i].key = keys[i];
+            memcpy ( rows[i].payload, &values[i], sizeof ( int ) );
+        }
+
+        exchangeByHash ( rows.data (  ), n, taskid, exchange, received, longest );
+        sentBytes = bytes[1];
+
+        initGroupTable ( table, longest );
+        for ( size_t i = 0; i < received.size (  ); i++ )
+        {
+            int value;
+            memcpy ( &value, received[i].payload, sizeof ( int ) );
+            addRows ( table, &received[i].key, &value, 1 );
+        }
+    }
+
+    tableGroups ( table, groups );
+}
+
+ /**writeGroups
+ *@fn bool writeGroups ( const char* fileName, MPI_Comm comm, const vector<Aggregate>& groups )
+ *@brief Writes every rank's groups, in rank order, as text lines of key count sum min max. Each rank prints its lines,
+ *       finds its offset with MPI_Exscan and writes them with MPI_File_write_at_all. This is collective.
+ *@param fileName The file to write
+ *@param comm The ranks writing
+ *@param groups This rank's groups
+ *@return false on every rank if the file could not be opened or any rank's write failed
+ *@pre Every rank in comm calls this
+ *@post fileName holds every rank's groups, rank 0's first
+ */
+bool writeGroups ( const char* fileName, MPI_Comm comm, const vector<Aggregate>& groups )
+{
+    string text;
+    char line[96];
+
+    for ( size_t i = 0; i < groups.size (  ); i++ )
+    {
+        int length = snprintf ( line, sizeof ( line ), "%d %lld %lld %d %d\n", groups[i].key, groups[i].count,
+                                groups[i].sum, groups[i].min, groups[i].max );
+        text.append ( line, length );
+    }
+
+    MPI_File file;
+    long long bytes = text.size (  ), before = 0, total;
+    int rank;
+
+    MPI_Comm_rank ( comm, &rank );
+
+    //Where this rank's lines go and how long the file is
+    MPI_Exscan ( &bytes, &before, 1, MPI_LONG_LONG, MPI_SUM, comm );
+    if ( rank == 0 )
+        before = 0;
+    MPI_Allreduce ( &bytes, &total, 1, MPI_LONG_LONG, MPI_SUM, comm );
+
+    if ( MPI_File_open ( comm, fileName, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &file ) != MPI_SUCCESS )
+        return false;
+
+    int written = MPI_File_set_size ( file, total ) == MPI_SUCCESS;
+    written = writeAtAll ( file, before, text.data (  ), bytes, MPI_BYTE, comm ) && written;
+    written = MPI_File_close ( &file ) == MPI_SUCCESS && written;
+
+    //Every rank fails if any write came up short
+    MPI_Allreduce ( MPI_IN_PLACE, &written, 1, MPI_INT, MPI_LAND, comm );
+
+    return written;
+}
+
+ /**findGroup
+ *@fn Aggregate& findGroup ( GroupTable& table, int key )
+ *@brief Finds the group of a key, starting at the slot its hash picks and probing the slots after it, and starts an
+ *       empty group in the first free slot if there is none. The table grows first if one more group would make it
+ *       more than half full.
+ *@param table The table
+ *@param key The key
+ *@return The group, with a count of 0 if it is new
+ *@pre table was set up by initGroupTable
+ *@post key has a group in table
+ */
+static Aggregate& findGroup ( GroupTable& table, int key )
+{
+    if ( 2 * ( table.used + 1 ) > table.slots.size (  ) )
+        growTable ( table );
+
+    size_t mask = table.slots.size (  ) - 1;
+    for ( size_t slot = groupHash ( key ) & mask; ; slot = ( slot + 1 ) & mask )
+    {
+        Aggregate& group = table.slots[slot];
+
+        if ( group.count == 0 )
+        {
+            group.key = key;
+            group.sum = 0;
+            group.min = 0x7fffffff;
+            group.max = -0x7fffffff - 1;
+            table.used++;
+            return group;
+        }
+
+        if ( group.key == key )
+            return group;
+    }
+}
+
+ /**growTable
+ *@fn void growTable ( GroupTable& table )
+ *@brief Doubles a table and puts every group back in its slot in the bigger one
+ *@param table The table
+ *@return N/A
+ *@pre N/A
+ *@post table holds the same groups in twice the slots
+ */
+static void growTable ( GroupTable& table )
+{
+    vector<Aggregate> old;
+    old.swap ( table.slots );
+
+    table.slots.assign ( old.size (  ) * 2, Aggregate (  ) );
+    size_t mask = table.slots.size (  ) - 1;
+
+    for ( size_t i = 0; i < old.size (  ); i++ )
+    {
+        if ( old[i].count == 0 )
+            continue;
+
+        size_t slot = groupHash ( old[i].key ) & mask;
+        while ( table.slots[slot].count != 0 )
+            slot = ( slot + 1 ) & mask;
+
+        table.slots[slot] = old[i];
+    }
+}
+
+ /**exchangeByHash
+ *@fn void exchangeByHash ( const R* records, size_t n, int taskid, ExchangeMode exchange, vector<R>& received, size_t& longest )
+ *@brief Partitions records by HashBuckets and sends each one to the rank that owns its key. This is collective.
+ *@param records This rank's records
+ *@param n The number of records
+ *@param taskid This rank
+ *@param exchange Whether to use MPI_Alltoallv or MPI_Ialltoallv
+ *@param received Where the records for this rank are stored
+ *@param longest Where the length of the longest run received is stored
+ *@return N/A
+ *@pre Every rank calls this with the same record type
+ *@post received holds every record whose key this rank owns
+ */
+template <typename R>
+void exchangeByHash ( const R* records, size_t n, int taskid, ExchangeMode exchange, vector<R>& received, size_t& longest )
+{
+    int numRanks;
+    MPI_Comm_size ( MPI_COMM_WORLD, &numRanks );
+
+    HashBuckets bucketOf = { numRanks };
+    vector<R> outgoing ( n );
+    vector<size_t> bucketStarts, runStarts;
+    partitionRecords ( records, n, numRanks, bucketOf, outgoing.data (  ), bucketStarts );
+
+    vector<long long> sendCounts ( numRanks );
+    for ( int i = 0; i < numRanks; i++ )
+        sendCounts[i] = bucketStarts[i + 1] - bucketStarts[i];
+
+    exchangeBuckets ( outgoing.data (  ), sendCounts, taskid, exchange, received, runStarts );
+
+    longest = 0;
+    for ( int i = 0; i < numRanks; i++ )
+        longest = max ( longest, ( i + 1 < numRanks ? runStarts[i + 1] : received.size (  ) ) - runStarts[i] );
+}
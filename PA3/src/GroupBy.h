@@ -0,0 +1,113 @@
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <vector>
+#include <cstddef>
+#include <stddef.h>
+#include "mpi.h"
+#include "KeyTraits.h"
+#include "Exchange.h"
+
+//Made up values go from 0 to VALUE_RANGE - 1
+#define VALUE_RANGE     1000
+
+//Slots a group table starts with, it doubles whenever it is half full
+#define GROUP_TABLE_MIN 1024
+
+//One group: the key and the count, sum, min and max of the values of its rows. A count of 0 is an empty slot.
+struct Aggregate
+{
+    long long count;
+    long long sum;
+    int key;
+    int min;
+    int max;
+};
+
+//Groups sort by key and are sent field by field, stretched to the size of the struct
+template <>
+struct RecordTraits<Aggregate>
+{
+    typedef int Key;
+    typedef KeyTraits<int>::Bits Bits;
+    static const bool PLAIN = false;
+
+    static const Key& key ( const Aggregate& group ) { return group.key; }
+    static Bits bits ( const Aggregate& group ) { return KeyTraits<int>::toBits ( group.key ); }
+
+    //Built on first use
+    static MPI_Datatype datatype (  )
+    {
+        static MPI_Datatype type = MPI_DATATYPE_NULL;
+
+        if ( type == MPI_DATATYPE_NULL )
+        {
+            int lengths[2] = { 2, 3 };
+            MPI_Aint displacements[2] = { offsetof ( Aggregate, count ), offsetof ( Aggregate, key ) };
+            MPI_Datatype types[2] = { MPI_LONG_LONG, MPI_INT };
+            MPI_Datatype packed;
+
+            MPI_Type_create_struct ( 2, lengths, displacements, types, &packed );
+            MPI_Type_create_resized ( packed, 0, sizeof ( Aggregate ), &type );
+            MPI_Type_commit ( &type );
+            MPI_Type_free ( &packed );
+        }
+
+        return type;
+    }
+};
+
+//An open addressing hash table of groups with linear probing, its size a power of two
+struct GroupTable
+{
+    std::vector<Aggregate> slots;
+    size_t used;
+};
+
+ /**groupHash
+ *@fn unsigned long long groupHash ( int key )
+ *@brief Mixes a key so every bit of the hash depends on every bit of the key. The low bits pick a slot in a group
+ *       table and the high bits pick a rank, so the keys a rank gets still spread over its table.
+ *@param key The key
+ *@return The hash
+ *@pre N/A
+ *@post N/A
+ */
+inline unsigned long long groupHash ( int key )
+{
+    unsigned long long hash = (unsigned int)key;
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+//A row sent as it is, its value carried as the payload
+typedef Record<int, sizeof ( int )> GroupRow;
+
+//Puts a group or a row in the bucket of the rank that owns its key
+struct HashBuckets
+{
+    int numBuckets;
+
+    template <typename R>
+    int operator() ( const R& record ) const
+    {
+        return ( ( groupHash ( RecordTraits<R>::key ( record ) ) >> 32 ) * numBuckets ) >> 32;
+    }
+};
+
+void makeValues ( int* values, long long first, size_t n, unsigned long long seed );
+void initGroupTable ( GroupTable& table, size_t groups );
+void addRows ( GroupTable& table, const int* keys, const int* values, size_t n );
+void addGroups ( GroupTable& table, const Aggregate* groups, size_t n );
+void tableGroups ( const GroupTable& table, std::vector<Aggregate>& groups );
+void groupBy ( const int* keys, const int* values, size_t n, int taskid, ExchangeMode exchange,
+               std::vector<Aggregate>& groups, long long& sentBytes, long long& rowBytes );
+bool writeGroups ( const char* fileName, MPI_Comm comm, const std::vector<Aggregate>& groups );
+
+#endif
@@ -0,0 +1,104 @@
+/** @file Heavy.cpp
+  * @brief Heavy hitters, keys so common that whichever rank owns them gets far more than its share. They are found
+  *        from a sample, taken out of the keys before they are partitioned and kept as one count per key that every
+  *        rank agrees on, so they are never sent or sorted and are only written out as runs at the end.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Heavy.h"
+#include <algorithm>
+
+using namespace std;
+
+ /**findHeavyKeys
+ *@fn void findHeavyKeys ( const vector<int>& keys, MPI_Comm comm, vector<int>& heavy )
+ *@brief Every rank takes HEAVY_SAMPLES evenly spaced keys, the samples are allgathered and sorted, and any key that
+ *       is more than 1 / ( HEAVY_SHARE * numRanks ) of them is heavy. This is collective.
+ *@param keys This rank's keys
+ *@param comm The ranks holding the keys
+ *@param heavy Where the heavy keys are stored
+ *@return N/A
+ *@pre Every rank in comm calls this
+ *@post heavy is the same on every rank and in ascending order, with at most HEAVY_SHARE * numRanks keys
+ */
+void findHeavyKeys ( const vector<int>& keys, MPI_Comm comm, vector<int>& heavy )
+{
+    int numRanks;
+    MPI_Comm_size ( comm, &numRanks );
+
+    int numSamples = min ( keys.size (  ), (size_t)HEAVY_SAMPLES );
+    vector<int> samples ( numSamples ), counts ( numRanks ), displacements ( numRanks );
+
+    for ( int i = 0; i < numSamples; i++ )
+        samples[i] = keys[( keys.size (  ) * i ) / numSamples];
+
+    MPI_Allgather ( &numSamples, 1, MPI_INT, counts.data (  ), 1, MPI_INT, comm );
+
+    int total = 0;
+    for ( int i = 0; i < numRanks; i++ )
+    {
+        displacements[i] = total;
+        total += counts[i];
+    }
+
+    vector<int> allSamples ( total );
+    MPI_Allgatherv ( samples.data (  ), numSamples, MPI_INT, allSamples.data (  ), counts.data (  ),
+                     displacements.data (  ), MPI_INT, comm );
+
+    sort ( allSamples.begin (  ), allSamples.end (  ) );
+
+    //Each run of equal samples is one key
+    heavy.clear (  );
+    for ( int i = 0, j; i < total; i = j )
+    {
+        j = upper_bound ( allSamples.begin (  ) + i, allSamples.end (  ), allSamples[i] ) - allSamples.begin (  );
+
+        if ( (long long)( j - i ) * HEAVY_SHARE * numRanks > total )
+            heavy.push_back ( allSamples[i] );
+    }
+}
+
+ /**splitHeavyKeys
+ *@fn void splitHeavyKeys ( vector<int>& keys, MPI_Comm comm, vector<KeyRun>& runs )
+ *@brief Finds the heavy keys, takes them out of this rank's keys while counting them in the same pass, and sums the
+ *       counts over every rank. Nothing is done past the sample if no key is heavy. This is collective.
+ *@param keys This rank's keys
+ *@param comm The ranks holding the keys
+ *@param runs Where each heavy key and how many times it appears over every rank are stored
+ *@return N/A
+ *@pre Every rank in comm calls this
+ *@post keys holds the rest of its keys in the same order and runs is the same on every rank, sorted by key
+ */
+void splitHeavyKeys ( vector<int>& keys, MPI_Comm comm, vector<KeyRun>& runs )
+{
+    vector<int> heavy;
+    findHeavyKeys ( keys, comm, heavy );
+
+    runs.clear (  );
+    if ( heavy.empty (  ) )
+        return;
+
+    vector<long long> counts ( heavy.size (  ), 0 );
+    size_t kept = 0;
+
+    for ( size_t i = 0; i < keys.size (  ); i++ )
+    {
+        vector<int>::iterator found = lower_bound ( heavy.begin (  ), heavy.end (  ), keys[i] );
+
+        if ( found != heavy.end (  ) && *found == keys[i] )
+            counts[found - heavy.begin (  )]++;
+        else
+            keys[kept++] = keys[i];
+    }
+    keys.resize ( kept );
+
+    MPI_Allreduce ( MPI_IN_PLACE, counts.data (  ), counts.size (  ), MPI_LONG_LONG, MPI_SUM, comm );
+
+    for ( size_t j = 0; j < heavy.size (  ); j++ )
+    {
+        KeyRun run = { heavy[j], counts[j] };
+        runs.push_back ( run );
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef HEAVY_H
+#define HEAVY_H
+
+#include <vector>
+#include "mpi.h"
+#include "KeyFile.h"
+
+//Keys each rank samples to look for heavy hitters
+#define HEAVY_SAMPLES   256
+
+//A key is heavy if it is more than 1 / ( HEAVY_SHARE * numRanks ) of the sample, half of one rank's share
+#define HEAVY_SHARE     2
+
+void findHeavyKeys ( const std::vector<int>& keys, MPI_Comm comm, std::vector<int>& heavy );
+void splitHeavyKeys ( std::vector<int>& keys, MPI_Comm comm, std::vector<KeyRun>& runs );
+
+#endif
@@ -0,0 +1,496 @@
+/** @file KeyFile.cpp
+  * @brief Binary key files: a small header and then the keys as raw ints, so every rank can read its own slice
+  *        straight from the file with MPI-IO and a single process can map the whole file
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "KeyFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+using namespace std;
+
+static bool moved ( int result, MPI_Status& status, MPI_Datatype type, long long count );
+static bool writeFileAll ( const char* fileName, MPI_Comm comm, const char* magic, const void* buffer, long long count,
+                           MPI_Datatype type, size_t size );
+
+ /**writeAtAll
+ *@fn bool writeAtAll ( MPI_File file, MPI_Offset offset, const void* buffer, long long count, MPI_Datatype type, MPI_Comm comm )
+ *@brief MPI_File_write_at_all for any count, in pieces of IO_CHUNK. Every rank makes as many calls as the rank with
+ *       the most pieces, writing nothing once it is done. This is collective.
+ *@param file The file
+ *@param offset Where in the file this rank's elements go, in bytes
+ *@param buffer The elements
+ *@param count The number of elements
+ *@param type The MPI datatype of an element
+ *@param comm The ranks the file was opened by
+ *@return false if a write failed or came up short on this rank
+ *@pre Every rank in comm calls this
+ *@post The elements are written if true is returned
+ */
+bool writeAtAll ( MPI_File file, MPI_Offset offset, const void* buffer, long long count, MPI_Datatype type, MPI_Comm comm )
+{
+    bool complete = true;
+
+    MPI_Aint lowerBound, extent;
+    MPI_Type_get_extent ( type, &lowerBound, &extent );
+
+    long long pieces = ( count + IO_CHUNK - 1 ) / IO_CHUNK;
+    MPI_Allreduce ( MPI_IN_PLACE, &pieces, 1, MPI_LONG_LONG, MPI_MAX, comm );
+
+    for ( long long piece = 0; piece < pieces; piece++ )
+    {
+        long long at = min ( piece * IO_CHUNK, count );
+        long long length = min ( (long long)IO_CHUNK, count - at );
+        MPI_Status status;
+
+        int result = MPI_File_write_at_all ( file, offset + at * extent, (const char*)buffer + at * extent, length, type, &status );
+        complete = moved ( result, status, type, length ) && complete;
+    }
+
+    return complete;
+}
+
+ /**readAtAll
+ *@fn bool readAtAll ( MPI_File file, MPI_Offset offset, void* buffer, long long count, MPI_Datatype type, MPI_Comm comm )
+ *@brief MPI_File_read_at_all for any count, in pieces of IO_CHUNK like writeAtAll. This is collective.
+ *@param file The file
+ *@param offset Where in the file this rank's elements are, in bytes
+ *@param buffer Where the elements are stored
+ *@param count The number of elements
+ *@param type The MPI datatype of an element
+ *@param comm The ranks the file was opened by
+ *@return false if a read failed or came up short on this rank
+ *@pre Every rank in comm calls this
+ *@post The elements are read if true is returned
+ */
+bool readAtAll ( MPI_File file, MPI_Offset offset, void* buffer, long long count, MPI_Datatype type, MPI_Comm comm )
+{
+    bool complete = true;
+
+    MPI_Aint lowerBound, extent;
+    MPI_Type_get_extent ( type, &lowerBound, &extent );
+
+    long long pieces = ( count + IO_CHUNK - 1 ) / IO_CHUNK;
+    MPI_Allreduce ( MPI_IN_PLACE, &pieces, 1, MPI_LONG_LONG, MPI_MAX, comm );
+
+    for ( long long piece = 0; piece < pieces; piece++ )
+    {
+        long long at = min ( piece * IO_CHUNK, count );
+        long long length = min ( (long long)IO_CHUNK, count - at );
+        MPI_Status status;
+
+        int result = MPI_File_read_at_all ( file, offset + at * extent, (char*)buffer + at * extent, length, type, &status );
+        complete = moved ( result, status, type, length ) && complete;
+    }
+
+    return complete;
+}
+
+ /**writeAt
+ *@fn bool writeAt ( MPI_File file, MPI_Offset offset, const void* buffer, long long count, MPI_Datatype type )
+ *@brief MPI_File_write_at for any count, in pieces of IO_CHUNK
+ *@param file The file
+ *@param offset Where in the file the elements go, in bytes
+ *@param buffer The elements
+ *@param count The number of elements
+ *@param type The MPI datatype of an element
+ *@return false if a write failed or came up short
+ *@pre N/A
+ *@post The elements are written if true is returned
+ */
+bool writeAt ( MPI_File file, MPI_Offset offset, const void* buffer, long long count, MPI_Datatype type )
+{
+    MPI_Aint lowerBound, extent;
+    MPI_Type_get_extent ( type, &lowerBound, &extent );
+
+    for ( long long at = 0; at < count; at += IO_CHUNK )
+    {
+        long long length = min ( (long long)IO_CHUNK, count - at );
+        MPI_Status status;
+
+        int result = MPI_File_write_at ( file, offset + at * extent, (const char*)buffer + at * extent, length, type, &status );
+        if ( !moved ( result, status, type, length ) )
+            return false;
+    }
+
+    return true;
+}
+
+ /**writeKeyFile
+ *@fn bool writeKeyFile ( const char* fileName, const int* keys, long long count )
+ *@brief Writes keys as a key file
+ *@param fileName The file to write
+ *@param keys The keys
+ *@param count The number of keys
+ *@return false if the file could not be written
+ *@pre N/A
+ *@post fileName holds the header and the keys
+ */
+bool writeKeyFile ( const char* fileName, const int* keys, long long count )
+{
+    KeyFileHeader header;
+    memcpy ( header.magic, KEYFILE_MAGIC, sizeof ( header.magic ) );
+    header.version = KEYFILE_VERSION;
+    header.count = count;
+
+    FILE* fout = fopen ( fileName, "wb" );
+
+    if ( fout == NULL )
+        return false;
+
+    bool written = fwrite ( &header, sizeof ( header ), 1, fout ) == 1
+                   && fwrite ( keys, sizeof ( int ), count, fout ) == (size_t)count;
+
+    return fclose ( fout ) == 0 && written;
+}
+
+ /**writeKeyFileAll
+ *@fn bool writeKeyFileAll ( const char* fileName, MPI_Comm comm, const int* keys, long long count )
+ *@brief Writes every rank's keys, in rank order, as one key file. Each rank's offset is the MPI_Exscan of the counts
+ *       before it, and the ranks write their ranges side by side with MPI_File_write_at_all, so nothing is gathered
+ *       on one rank. This is collective.
+ *@param fileName The file to write
+ *@param comm The ranks writing
+ *@param keys This rank's keys
+ *@param count The number of keys this rank has
+ *@return false on every rank if the file could not be opened
+ *@pre Every rank in comm calls this
+ *@post fileName holds the header and every rank's keys, rank 0's first
+ */
+bool writeKeyFileAll ( const char* fileName, MPI_Comm comm, const int* keys, long long count )
+{
+    return writeFileAll ( fileName, comm, KEYFILE_MAGIC, keys, count, MPI_INT, sizeof ( int ) );
+}
+
+ /**writeRowFileAll
+ *@fn bool writeRowFileAll ( const char* fileName, MPI_Comm comm, const long long* rows, long long count )
+ *@brief writeKeyFileAll for row numbers, written as a row file. This is collective.
+ *@param fileName The file to write
+ *@param comm The ranks writing
+ *@param rows This rank's row numbers
+ *@param count The number of row numbers this rank has
+ *@return false on every rank if the file could not be opened
+ *@pre Every rank in comm calls this
+ *@post fileName holds the header and every rank's row numbers, rank 0's first
+ */
+bool writeRowFileAll ( const char* fileName, MPI_Comm comm, const long long* rows, long long count )
+{
+    return writeFileAll ( fileName, comm, ROWFILE_MAGIC, rows, count, MPI_LONG_LONG, sizeof ( long long ) );
+}
+
+ /**writeFileAll
+ *@fn bool writeFileAll ( const char* fileName, MPI_Comm comm, const char* magic, const void* buffer, long long count, MPI_Datatype type, size_t size )
+ *@brief Writes every rank's elements after a header, in rank order, for writeKeyFileAll and writeRowFileAll. This is
+ *       collective.
+ *@param fileName The file to write
+ *@param comm The ranks writing
+ *@param magic What the file starts with
+ *@param buffer This rank's elements
+ *@param count The number of elements this rank has
+ *@param type The MPI datatype of an element
+ *@param size The bytes in an element
+ *@return false on every rank if the file could not be opened or any rank's write failed
+ *@pre Every rank in comm calls this
+ *@post fileName holds the header and every rank's elements, rank 0's first
+ */
+static bool writeFileAll ( const char* fileName, MPI_Comm comm, const char* magic, const void* buffer, long long count,
+                           MPI_Datatype type, size_t size )
+{
+    MPI_File file;
+    KeyFileHeader header;
+    long long before = 0, total;
+    int rank;
+
+    MPI_Comm_rank ( comm, &rank );
+
+    //Where this rank's elements go and how many there are in all
+    MPI_Exscan ( &count, &before, 1, MPI_LONG_LONG, MPI_SUM, comm );
+    if ( rank == 0 )
+        before = 0;
+    MPI_Allreduce ( &count, &total, 1, MPI_LONG_LONG, MPI_SUM, comm );
+
+    if ( MPI_File_open ( comm, fileName, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &file ) != MPI_SUCCESS )
+        return false;
+
+    //Drop whatever an older, longer file left past the end
+    int written = MPI_File_set_size ( file, sizeof ( header ) + total * size ) == MPI_SUCCESS;
+
+    memcpy ( header.magic, magic, sizeof ( header.magic ) );
+    header.version = KEYFILE_VERSION;
+    header.count = total;
+
+    //Rank 0 writes the header, everyone else joins in with nothing
+    MPI_Status status;
+    int headerBytes = rank == 0 ? sizeof ( header ) : 0;
+    int result = MPI_File_write_at_all ( file, 0, &header, headerBytes, MPI_BYTE, &status );
+    written = moved ( result, status, MPI_BYTE, headerBytes ) && written;
+
+    MPI_Offset offset = sizeof ( header ) + before * size;
+    written = writeAtAll ( file, offset, buffer, count, type, comm ) && written;
+
+    written = MPI_File_close ( &file ) == MPI_SUCCESS && written;
+
+    //Every rank fails if any write came up short
+    MPI_Allreduce ( MPI_IN_PLACE, &written, 1, MPI_INT, MPI_LAND, comm );
+
+    return written;
+}
+
+ /**writeKeyFileRuns
+ *@fn bool writeKeyFileRuns ( const char* fileName, MPI_Comm comm, const int* keys, long long count, const vector<KeyRun>& runs )
+ *@brief writeKeyFileAll with runs of keys slotted in where they sort. Every rank counts its keys below each run and the
+ *       counts are summed, which with the runs before it says where each run starts. Each rank writes its keys in
+ *       pieces between the runs, and a 1 / numRanks slice of every run, so the runs are filled in by every rank side
+ *       by side. This is collective.
+ *@param fileName The file to write
+ *@param comm The ranks writing
+ *@param keys This rank's keys
+ *@param count The number of keys this rank has
+ *@param runs The runs, the same on every rank
+ *@return false on every rank if the file could not be opened or any rank's write failed
+ *@pre Every rank in comm calls this, the keys are sorted over the ranks in rank order and the runs are sorted by key
+ *@post fileName holds the header and every key and run in order
+ */
+bool writeKeyFileRuns ( const char* fileName, MPI_Comm comm, const int* keys, long long count, const vector<KeyRun>& runs )
+{
+    MPI_File file;
+    KeyFileHeader header;
+    long long before = 0, total;
+    int rank, numRanks;
+
+    MPI_Comm_rank ( comm, &rank );
+    MPI_Comm_size ( comm, &numRanks );
+
+    //Where this rank's keys go, not counting the runs, and how many there are in all
+    MPI_Exscan ( &count, &before, 1, MPI_LONG_LONG, MPI_SUM, comm );
+    if ( rank == 0 )
+        before = 0;
+    MPI_Allreduce ( &count, &total, 1, MPI_LONG_LONG, MPI_SUM, comm );
+
+    //A run starts after every key below it, on any rank, and every run before it
+    vector<long long> starts ( runs.size (  ) );
+    for ( size_t j = 0; j < runs.size (  ); j++ )
+        starts[j] = lower_bound ( keys, keys + count, runs[j].key ) - keys;
+    MPI_Allreduce ( MPI_IN_PLACE, starts.data (  ), runs.size (  ), MPI_LONG_LONG, MPI_SUM, comm );
+
+    long long runKeys = 0;
+    for ( size_t j = 0; j < runs.size (  ); j++ )
+    {
+        starts[j] += runKeys;
+        runKeys += runs[j].count;
+    }
+
+    if ( MPI_File_open ( comm, fileName, MPI_MODE_WRONLY | MPI_MODE_CREATE, MPI_INFO_NULL, &file ) != MPI_SUCCESS )
+        return false;
+
+    //Drop whatever an older, longer file left past the end
+    int written = MPI_File_set_size ( file, sizeof ( header ) + ( total + runKeys ) * sizeof ( int ) ) == MPI_SUCCESS;
+
+    memcpy ( header.magic, KEYFILE_MAGIC, sizeof ( header.magic ) );
+    header.version = KEYFILE_VERSION;
+    header.count = total + runKeys;
+
+    //Rank 0 writes the header, everyone else joins in with nothing
+    MPI_Status status;
+    int headerBytes = rank == 0 ? sizeof ( header ) : 0;
+    int result = MPI_File_write_at_all ( file, 0, &header, headerBytes, MPI_BYTE, &status );
+    written = moved ( result, status, MPI_BYTE, headerBytes ) && written;
+
+    //Each piece of this rank's keys goes after the runs below it
+    long long i = 0, runsBefore = 0;
+    size_t j = 0;
+    while ( written && i < count )
+    {
+        for ( ; j < runs.size (  ) && runs[j].key <= keys[i]; j++ )
+            runsBefore += runs[j].count;
+
+        long long end = j < runs.size (  ) ? lower_bound ( keys + i, keys + count, runs[j].key ) - keys : count;
+
+        MPI_Offset offset = sizeof ( header ) + ( before + i + runsBefore ) * sizeof ( int );
+        written = writeAt ( file, offset, keys + i, end - i, MPI_INT );
+        i = end;
+    }
+
+    //This rank's slice of each run, a block at a time
+    vector<int> block;
+    for ( j = 0; written && j < runs.size (  ); j++ )
+    {
+        long long from = runs[j].count * rank / numRanks, to = runs[j].count * ( rank + 1 ) / numRanks;
+        block.assign ( min ( (long long)RUN_BLOCK, to - from ), runs[j].key );
+
+        for ( long long at = from; written && at < to; at += RUN_BLOCK )
+        {
+            MPI_Offset offset = sizeof ( header ) + ( starts[j] + at ) * sizeof ( int );
+            written = writeAt ( file, offset, block.data (  ), min ( (long long)RUN_BLOCK, to - at ), MPI_INT );
+        }
+    }
+
+    written = MPI_File_close ( &file ) == MPI_SUCCESS && written;
+
+    //Every rank fails if any write came up short
+    MPI_Allreduce ( MPI_IN_PLACE, &written, 1, MPI_INT, MPI_LAND, comm );
+
+    return written;
+}
+
+ /**readKeyFileHeader
+ *@fn bool readKeyFileHeader ( MPI_File file, KeyFileHeader& header )
+ *@brief Every rank reads the same few bytes of header, which the library turns into one read, and checks that the
+ *       file holds as many keys as the header says. This is collective.
+ *@param file The key file, open for reading
+ *@param header Where the header is stored
+ *@return false if the header could not be read, is not a key file's, or counts more keys than the file holds
+ *@pre Every rank that opened file calls this
+ *@post header is the file's header if true is returned
+ */
+bool readKeyFileHeader ( MPI_File file, KeyFileHeader& header )
+{
+    MPI_Status status;
+    MPI_Offset fileSize;
+    int result = MPI_File_read_at_all ( file, 0, &header, sizeof ( header ), MPI_BYTE, &status );
+
+    //The header has to be whole and the file as long as it says
+    return moved ( result, status, MPI_BYTE, sizeof ( header ) ) && MPI_File_get_size ( file, &fileSize ) == MPI_SUCCESS &&
+           memcmp ( header.magic, KEYFILE_MAGIC, sizeof ( header.magic ) ) == 0 && header.version == KEYFILE_VERSION &&
+           header.count >= 0 && header.count <= (long long)( ( fileSize - sizeof ( header ) ) / sizeof ( int ) );
+}
+
+ /**readKeyFile
+ *@fn bool readKeyFile ( const char* fileName, MPI_Comm comm, vector<int>& keys, long long& totalNums )
+ *@brief Every rank reads the header and then its own contiguous slice of the keys with MPI_File_read_at_all, so the
+ *       reads happen side by side and the MPI-IO layer can merge them into large requests. This is collective.
+ *@param fileName The key file
+ *@param comm The ranks sharing the keys
+ *@param keys Where this rank's slice is stored
+ *@param totalNums Where the number of keys in the file is stored
+ *@return false on every rank if the file could not be opened or read, is not a key file or is shorter than its count
+ *@pre Every rank in comm calls this
+ *@post Rank r of p holds keys totalNums * r / p up to totalNums * ( r + 1 ) / p
+ */
+bool readKeyFile ( const char* fileName, MPI_Comm comm, vector<int>& keys, long long& totalNums )
+{
+    MPI_File file;
+    KeyFileHeader header;
+    int rank, size;
+
+    MPI_Comm_rank ( comm, &rank );
+    MPI_Comm_size ( comm, &size );
+
+    if ( MPI_File_open ( comm, fileName, MPI_MODE_RDONLY, MPI_INFO_NULL, &file ) != MPI_SUCCESS )
+        return false;
+
+    if ( !readKeyFileHeader ( file, header ) )
+    {
+        MPI_File_close ( &file );
+        return false;
+    }
+
+    totalNums = header.count;
+
+    long long first = totalNums * rank / size;
+    long long last = totalNums * ( rank + 1 ) / size;
+    keys.resize ( last - first );
+
+    MPI_Offset offset = sizeof ( header ) + first * sizeof ( int );
+    int complete = readAtAll ( file, offset, keys.data (  ), keys.size (  ), MPI_INT, comm );
+
+    MPI_File_close ( &file );
+
+    //Every rank fails if any read came up short
+    MPI_Allreduce ( MPI_IN_PLACE, &complete, 1, MPI_INT, MPI_LAND, comm );
+
+    return complete;
+}
+
+ /**mapKeyFile
+ *@fn bool mapKeyFile ( const char* fileName, KeyMap& keyMap )
+ *@brief Maps a key file read only, so the keys are paged in as they are first touched instead of being copied in
+ *@param fileName The key file
+ *@param keyMap Where the keys and the mapping are stored
+ *@return false if the file could not be mapped or is not a key file
+ *@pre N/A
+ *@post keyMap.keys holds keyMap.count keys until unmapKeyFile
+ */
+bool mapKeyFile ( const char* fileName, KeyMap& keyMap )
+{
+    struct stat info;
+    int fd = open ( fileName, O_RDONLY );
+
+    if ( fd < 0 )
+        return false;
+
+    if ( fstat ( fd, &info ) != 0 || (size_t)info.st_size < sizeof ( KeyFileHeader ) )
+    {
+        close ( fd );
+        return false;
+    }
+
+    void* map = mmap ( NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close ( fd );
+
+    if ( map == MAP_FAILED )
+        return false;
+
+    const KeyFileHeader* header = (const KeyFileHeader*)map;
+
+    if ( memcmp ( header->magic, KEYFILE_MAGIC, sizeof ( header->magic ) ) != 0 || header->version != KEYFILE_VERSION
+         || header->count < 0 || header->count > (long long)( ( info.st_size - sizeof ( KeyFileHeader ) ) / sizeof ( int ) ) )
+    {
+        munmap ( map, info.st_size );
+        return false;
+    }
+
+    //The keys are read front to back
+    madvise ( map, info.st_size, MADV_SEQUENTIAL );
+
+    keyMap.keys = (const int*)( header + 1 );
+    keyMap.count = header->count;
+    keyMap.map = map;
+    keyMap.mapLength = info.st_size;
+
+    return true;
+}
+
+ /**unmapKeyFile
+ *@fn void unmapKeyFile ( KeyMap& keyMap )
+ *@brief Unmaps a key file
+ *@param keyMap The mapped file
+ *@return N/A
+ *@pre keyMap came from mapKeyFile
+ *@post keyMap.keys is no longer valid
+ */
+void unmapKeyFile ( KeyMap& keyMap )
+{
+    munmap ( keyMap.map, keyMap.mapLength );
+    keyMap.keys = NULL;
+    keyMap.count = 0;
+}
+
+ /**moved
+ *@fn bool moved ( int result, MPI_Status& status, MPI_Datatype type, long long count )
+ *@brief Whether an MPI-IO call succeeded and moved every element it was asked to
+ *@param result What the call returned
+ *@param status The status it filled in
+ *@param type The MPI datatype of an element
+ *@param count The number of elements asked for
+ *@return true if the call succeeded and moved count elements
+ *@pre status came from the call if it succeeded
+ *@post N/A
+ */
+static bool moved ( int result, MPI_Status& status, MPI_Datatype type, long long count )
+{
+    int got;
+
+    if ( result != MPI_SUCCESS || MPI_Get_count ( &status, type, &got ) != MPI_SUCCESS )
+        return false;
+
+    return got == count;
+}
@@ -0,0 +1,58 @@
+#ifndef KEYFILE_H
+#define KEYFILE_H
+
+#include <vector>
+#include <cstddef>
+#include "mpi.h"
+
+#define KEYFILE_MAGIC   "KEYS"
+#define KEYFILE_VERSION 1
+
+//A row file has the same header and then count native-endian long long row numbers
+#define ROWFILE_MAGIC   "ROWS"
+
+//Keys of a run filled in and written at a time
+#define RUN_BLOCK       ( 1 << 16 )
+
+//Largest count handed to one MPI-IO call, MPI counts are ints
+#define IO_CHUNK        ( 1 << 30 )
+
+//The start of a key file, followed by count native-endian ints
+struct KeyFileHeader
+{
+    char magic[4];
+    int version;
+    long long count;
+};
+
+//A key file mapped into memory
+struct KeyMap
+{
+    const int* keys;
+    long long count;
+
+    //What to unmap
+    void* map;
+    size_t mapLength;
+};
+
+//count copies of one key, kept as the pair until they are written
+struct KeyRun
+{
+    int key;
+    long long count;
+};
+
+bool writeAtAll ( MPI_File file, MPI_Offset offset, const void* buffer, long long count, MPI_Datatype type, MPI_Comm comm );
+bool readAtAll ( MPI_File file, MPI_Offset offset, void* buffer, long long count, MPI_Datatype type, MPI_Comm comm );
+bool writeAt ( MPI_File file, MPI_Offset offset, const void* buffer, long long count, MPI_Datatype type );
+bool writeKeyFile ( const char* fileName, const int* keys, long long count );
+bool writeKeyFileAll ( const char* fileName, MPI_Comm comm, const int* keys, long long count );
+bool writeRowFileAll ( const char* fileName, MPI_Comm comm, const long long* rows, long long count );
+bool writeKeyFileRuns ( const char* fileName, MPI_Comm comm, const int* keys, long long count, const std::vector<KeyRun>& runs );
+bool readKeyFileHeader ( MPI_File file, KeyFileHeader& header );
+bool readKeyFile ( const char* fileName, MPI_Comm comm, std::vector<int>& keys, long long& totalNums );
+bool mapKeyFile ( const char* fileName, KeyMap& keyMap );
+void unmapKeyFile ( KeyMap& keyMap );
+
+#endif
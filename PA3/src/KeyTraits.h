@@ -0,0 +1,187 @@
+#ifndef KEYTRAITS_H
+#define KEYTRAITS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include "mpi.h"
+
+//How a key type sorts. Bits is an unsigned type whose order matches the order of the keys, which is what radix sort
+//and every comparison work on, and datatype is the MPI type the key is sent as.
+template <typename K>
+struct KeyTraits;
+
+template <>
+struct KeyTraits<int>
+{
+    typedef uint32_t Bits;
+
+    //Flipping the sign bit makes the unsigned order match the signed order
+    static Bits toBits ( int key ) { return (Bits)key ^ 0x80000000u; }
+    static int fromBits ( Bits bits ) { return (int)( bits ^ 0x80000000u ); }
+    static MPI_Datatype datatype (  ) { return MPI_INT; }
+};
+
+template <>
+struct KeyTraits<long long>
+{
+    typedef uint64_t Bits;
+
+    static Bits toBits ( long long key ) { return (Bits)key ^ 0x8000000000000000ull; }
+    static long long fromBits ( Bits bits ) { return (long long)( bits ^ 0x8000000000000000ull ); }
+    static MPI_Datatype datatype (  ) { return MPI_LONG_LONG; }
+};
+
+template <>
+struct KeyTraits<unsigned int>
+{
+    typedef uint32_t Bits;
+
+    static Bits toBits ( unsigned int key ) { return key; }
+    static unsigned int fromBits ( Bits bits ) { return bits; }
+    static MPI_Datatype datatype (  ) { return MPI_UNSIGNED; }
+};
+
+template <>
+struct KeyTraits<unsigned long long>
+{
+    typedef uint64_t Bits;
+
+    static Bits toBits ( unsigned long long key ) { return key; }
+    static unsigned long long fromBits ( Bits bits ) { return bits; }
+    static MPI_Datatype datatype (  ) { return MPI_UNSIGNED_LONG_LONG; }
+};
+
+template <>
+struct KeyTraits<float>
+{
+    typedef uint32_t Bits;
+
+    //Negative floats order backwards, so all their bits flip, and positive ones go above them by setting the sign bit
+    static Bits toBits ( float key )
+    {
+        Bits bits;
+        memcpy ( &bits, &key, sizeof ( bits ) );
+        return ( bits & 0x80000000u ) ? ~bits : bits | 0x80000000u;
+    }
+
+    static float fromBits ( Bits bits )
+    {
+        float key;
+        bits = ( bits & 0x80000000u ) ? bits & 0x7fffffffu : ~bits;
+        memcpy ( &key, &bits, sizeof ( key ) );
+        return key;
+    }
+
+    static MPI_Datatype datatype (  ) { return MPI_FLOAT; }
+};
+
+template <>
+struct KeyTraits<double>
+{
+    typedef uint64_t Bits;
+
+    static Bits toBits ( double key )
+    {
+        Bits bits;
+        memcpy ( &bits, &key, sizeof ( bits ) );
+        return ( bits & 0x8000000000000000ull ) ? ~bits : bits | 0x8000000000000000ull;
+    }
+
+    static double fromBits ( Bits bits )
+    {
+        double key;
+        bits = ( bits & 0x8000000000000000ull ) ? bits & 0x7fffffffffffffffull : ~bits;
+        memcpy ( &key, &bits, sizeof ( key ) );
+        return key;
+    }
+
+    static MPI_Datatype datatype (  ) { return MPI_DOUBLE; }
+};
+
+//A key carrying PAYLOAD bytes along with it
+template <typename K, int PAYLOAD>
+struct Record
+{
+    K key;
+    char payload[PAYLOAD];
+};
+
+//How a record sorts: the key it sorts by, and the MPI type it is sent as. A plain key is a record of itself, and only
+//plain keys can be rebuilt from their bits.
+template <typename R>
+struct RecordTraits
+{
+    typedef R Key;
+    typedef typename KeyTraits<R>::Bits Bits;
+    static const bool PLAIN = true;
+
+    static const Key& key ( const R& record ) { return record; }
+    static Bits bits ( const R& record ) { return KeyTraits<R>::toBits ( record ); }
+    static MPI_Datatype datatype (  ) { return KeyTraits<R>::datatype (  ); }
+};
+
+template <typename K, int PAYLOAD>
+struct RecordTraits< Record<K, PAYLOAD> >
+{
+    typedef K Key;
+    typedef typename KeyTraits<K>::Bits Bits;
+    static const bool PLAIN = false;
+
+    static const Key& key ( const Record<K, PAYLOAD>& record ) { return record.key; }
+    static Bits bits ( const Record<K, PAYLOAD>& record ) { return KeyTraits<K>::toBits ( record.key ); }
+
+    //The key as its own type and the payload as bytes, stretched to the size of the struct. Built on first use.
+    static MPI_Datatype datatype (  )
+    {
+        static MPI_Datatype type = MPI_DATATYPE_NULL;
+
+        if ( type == MPI_DATATYPE_NULL )
+        {
+            int lengths[2] = { 1, PAYLOAD };
+            typedef Record<K, PAYLOAD> Self;
+            MPI_Aint displacements[2] = { offsetof ( Self, key ), offsetof ( Self, payload ) };
+            MPI_Datatype types[2] = { KeyTraits<K>::datatype (  ), MPI_BYTE };
+            MPI_Datatype packed;
+
+            MPI_Type_create_struct ( 2, lengths, displacements, types, &packed );
+            MPI_Type_create_resized ( packed, 0, sizeof ( Record<K, PAYLOAD> ), &type );
+            MPI_Type_commit ( &type );
+            MPI_Type_free ( &packed );
+        }
+
+        return type;
+    }
+};
+
+ /**keyLess
+ *@fn bool keyLess ( const R& a, const R& b )
+ *@brief Whether a sorts before b
+ *@param a A record
+ *@param b Another record
+ *@return true if a's key is smaller
+ *@pre N/A
+ *@post N/A
+ */
+template <typename R>
+inline bool keyLess ( const R& a, const R& b )
+{
+    return RecordTraits<R>::bits ( a ) < RecordTraits<R>::bits ( b );
+}
+
+ /**bitsLess
+ *@fn bool bitsLess ( typename RecordTraits<R>::Bits bits, const R& record )
+ *@brief Whether key bits sort before a record, for searching sorted records for a key
+ *@param bits The key bits
+ *@param record A record
+ *@return true if bits is smaller than the record's key bits
+ *@pre N/A
+ *@post N/A
+ */
+template <typename R>
+inline bool bitsLess ( typename RecordTraits<R>::Bits bits, const R& record )
+{
+    return bits < RecordTraits<R>::bits ( record );
+}
+
+#endif
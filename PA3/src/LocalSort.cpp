@@ -0,0 +1,55 @@
+/** @file LocalSort.cpp
+  * @brief Names for the strategies used to sort a single bucket. The strategies themselves are templates in LocalSort.h
+  *        so that each record type gets its own kernels.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.2
+  */
+
+#include "LocalSort.h"
+#include <string.h>
+
+using namespace std;
+
+ /**parseSortKind
+ *@fn bool parseSortKind ( const char* name, SortKind& kind )
+ *@brief Turns auto, radix, intro, network or flag into a SortKind
+ *@param name The name of the strategy
+ *@param kind Where the strategy is stored
+ *@return false if the name is not a strategy
+ *@pre N/A
+ *@post kind is set if true is returned
+ */
+bool parseSortKind ( const char* name, SortKind& kind )
+{
+    for ( int i = SORT_AUTO; i <= SORT_FLAG; i++ )
+    {
+        if ( strcmp ( name, sortKindName ( (SortKind)i ) ) == 0 )
+        {
+            kind = (SortKind)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ /**sortKindName
+ *@fn const char* sortKindName ( SortKind kind )
+ *@brief The name parseSortKind accepts for a strategy
+ *@param kind The strategy
+ *@return The name
+ *@pre N/A
+ *@post N/A
+ */
+const char* sortKindName ( SortKind kind )
+{
+    switch ( kind )
+    {
+        case SORT_RADIX:   return "radix";
+        case SORT_INTRO:   return "intro";
+        case SORT_NETWORK: return "network";
+        case SORT_FLAG:    return "flag";
+        default:           return "auto";
+    }
+}
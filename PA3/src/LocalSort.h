@@ -0,0 +1,497 @@
+#ifndef LOCALSORT_H
+#define LOCALSORT_H
+
+#include <vector>
+#include <cstddef>
+#include <string.h>
+#include <algorithm>
+#include "KeyTraits.h"
+
+//Buckets up to this size are finished by the sorting network
+#define NETWORK_MAX 16
+
+//Below this size introsort beats the fixed passes of radix sort
+#define RADIX_MIN   1024
+
+#define RADIX_BITS      8
+#define RADIX_SIZE      ( 1 << RADIX_BITS )
+#define INSERTION_MAX   16
+
+//The strategies that can finish a bucket
+enum SortKind
+{
+    //Picks by size: network, then introsort, then radix
+    SORT_AUTO,
+
+    //LSD radix sort, 8 bits a pass, skipping passes where every key has the same digit
+    SORT_RADIX,
+
+    //Introsort with insertion sort for small partitions
+    SORT_INTRO,
+
+    //Introsort with the sorting network for small partitions
+    SORT_NETWORK,
+
+    //In-place MSD radix sort, 8 bits a pass, needing no scratch
+    SORT_FLAG
+};
+
+bool parseSortKind ( const char* name, SortKind& kind );
+const char* sortKindName ( SortKind kind );
+
+//Whether a record type can use the sorting network, which only plain keys can
+template <bool PLAIN>
+struct NetworkTag {};
+
+ /**radixSort
+ *@fn void radixSort ( R* keys, size_t n )
+ *@brief LSD radix sort on the key bits. All the digit histograms come from one read of the keys, and a pass whose digit
+ *       is the same for every key is skipped, so small key ranges only pay for the digits they use.
+ *@param keys The records
+ *@param n The number of records
+ *@return N/A
+ *@pre keys holds n records
+ *@post keys is sorted, records with equal keys keep their order
+ */
+template <typename R>
+void radixSort ( R* keys, size_t n )
+{
+    typedef typename RecordTraits<R>::Bits Bits;
+    const int passes = sizeof ( Bits ) * 8 / RADIX_BITS;
+
+    size_t counts[passes][RADIX_SIZE];
+    memset ( counts, 0, sizeof ( counts ) );
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        Bits key = RecordTraits<R>::bits ( keys[i] );
+        for ( int pass = 0; pass < passes; pass++ )
+            counts[pass][( key >> ( pass * RADIX_BITS ) ) & ( RADIX_SIZE - 1 )]++;
+    }
+
+    std::vector<R> scratch ( n );
+    R* from = keys;
+    R* to = scratch.data (  );
+
+    for ( int pass = 0; pass < passes; pass++ )
+    {
+        int shift = pass * RADIX_BITS;
+
+        //Every key has the same digit, this pass would not move anything
+        if ( counts[pass][( RecordTraits<R>::bits ( from[0] ) >> shift ) & ( RADIX_SIZE - 1 )] == n )
+            continue;
+
+        //Turn the counts into starting offsets
+        size_t offset = 0;
+        for ( int digit = 0; digit < RADIX_SIZE; digit++ )
+        {
+            size_t count = counts[pass][digit];
+            counts[pass][digit] = offset;
+            offset += count;
+        }
+
+        for ( size_t i = 0; i < n; i++ )
+        {
+            unsigned int digit = ( RecordTraits<R>::bits ( from[i] ) >> shift ) & ( RADIX_SIZE - 1 );
+            to[counts[pass][digit]++] = from[i];
+        }
+
+        std::swap ( from, to );
+    }
+
+    if ( from != keys )
+        std::copy ( from, from + n, keys );
+}
+
+ /**insertionSort
+ *@fn void insertionSort ( R* keys, size_t n )
+ *@brief Insertion sort for small partitions
+ *@param keys The records
+ *@param n The number of records
+ *@return N/A
+ *@pre keys holds n records
+ *@post keys is sorted
+ */
+template <typename R>
+void insertionSort ( R* keys, size_t n )
+{
+    for ( size_t i = 1; i < n; i++ )
+    {
+        R key = keys[i];
+        size_t j = i;
+        while ( j > 0 && keyLess ( key, keys[j - 1] ) )
+        {
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        keys[j] = key;
+    }
+}
+
+ /**networkSort
+ *@fn void networkSort ( R* keys, size_t n, NetworkTag<true> )
+ *@brief Sorts up to NETWORK_MAX keys with a bitonic network. The key bits are padded to NETWORK_MAX with the largest
+ *       value and every stage is a fixed, branch-free min/max over all lanes, which the compiler unrolls and vectorizes.
+ *@param keys The keys
+ *@param n The number of keys
+ *@return N/A
+ *@pre n <= NETWORK_MAX
+ *@post keys is sorted
+ */
+template <typename R>
+void networkSort ( R* keys, size_t n, NetworkTag<true> )
+{
+    typedef typename RecordTraits<R>::Bits Bits;
+    Bits lanes[NETWORK_MAX], next[NETWORK_MAX];
+
+    for ( int i = 0; i < NETWORK_MAX; i++ )
+        lanes[i] = (size_t)i < n ? RecordTraits<R>::bits ( keys[i] ) : (Bits)~(Bits)0;
+
+    for ( int k = 2; k <= NETWORK_MAX; k <<= 1 )
+    {
+        for ( int j = k >> 1; j > 0; j >>= 1 )
+        {
+            for ( int i = 0; i < NETWORK_MAX; i++ )
+            {
+                int partner = i ^ j;
+                Bits low = std::min ( lanes[i], lanes[partner] );
+                Bits high = std::max ( lanes[i], lanes[partner] );
+
+                //The lower lane of an ascending pair keeps the min, the lower lane of a descending pair the max
+                bool ascending = ( i & k ) == 0;
+                next[i] = ( ( i < partner ) == ascending ) ? low : high;
+            }
+            memcpy ( lanes, next, sizeof ( lanes ) );
+        }
+    }
+
+    for ( size_t i = 0; i < n; i++ )
+        keys[i] = KeyTraits<R>::fromBits ( lanes[i] );
+}
+
+ /**networkSort
+ *@fn void networkSort ( R* keys, size_t n, NetworkTag<false> )
+ *@brief Records cannot be rebuilt from their key bits, so they finish with insertion sort instead
+ *@param keys The records
+ *@param n The number of records
+ *@return N/A
+ *@pre n <= NETWORK_MAX
+ *@post keys is sorted
+ */
+template <typename R>
+void networkSort ( R* keys, size_t n, NetworkTag<false> )
+{
+    insertionSort ( keys, n );
+}
+
+ /**introSort
+ *@fn void introSort ( R* keys, size_t n, int depth, bool network )
+ *@brief Median of three quicksort that switches to heapsort when it recurses too deep and finishes small partitions
+ *       with either insertion sort or the sorting network
+ *@param keys The records
+ *@param n The number of records
+ *@param depth The recursion left before switching to heapsort
+ *@param network Whether small partitions use the sorting network
+ *@return N/A
+ *@pre keys holds n records
+ *@post keys is sorted
+ */
+template <typename R>
+void introSort ( R* keys, size_t n, int depth, bool network )
+{
+    typedef typename RecordTraits<R>::Bits Bits;
+
+    while ( n > ( network ? NETWORK_MAX : INSERTION_MAX ) )
+    {
+        if ( depth-- == 0 )
+        {
+            std::make_heap ( keys, keys + n, keyLess<R> );
+            std::sort_heap ( keys, keys + n, keyLess<R> );
+            return;
+        }
+
+        //Median of the first, middle and last as the pivot
+        Bits a = RecordTraits<R>::bits ( keys[0] ), b = RecordTraits<R>::bits ( keys[n / 2] ), c = RecordTraits<R>::bits ( keys[n - 1] );
+        Bits pivot = std::max ( std::min ( a, b ), std::min ( std::max ( a, b ), c ) );
+
+        //Hoare partition
+        size_t i = 0, j = n - 1;
+        while ( true )
+        {
+            while ( RecordTraits<R>::bits ( keys[i] ) < pivot )
+                i++;
+            while ( RecordTraits<R>::bits ( keys[j] ) > pivot )
+                j--;
+            if ( i >= j )
+                break;
+            std::swap ( keys[i], keys[j] );
+            i++;
+            j--;
+        }
+
+        //Recurse into the smaller side and loop on the larger one
+        size_t left = j + 1;
+        if ( left < n - left )
+        {
+            introSort ( keys, left, depth, network );
+            keys += left;
+            n -= left;
+        }
+        else
+        {
+            introSort ( keys + left, n - left, depth, network );
+            n = left;
+        }
+    }
+
+    if ( network )
+        networkSort ( keys, n, NetworkTag<RecordTraits<R>::PLAIN> (  ) );
+    else
+        insertionSort ( keys, n );
+}
+
+ /**flagShift
+ *@fn int flagShift ( const R* keys, size_t n )
+ *@brief Where americanFlagSort starts, the lowest bit of the highest digit in which the keys are not all the same
+ *@param keys The records
+ *@param n The number of records
+ *@return The shift of the digit, or -1 if every key is the same
+ *@pre N/A
+ *@post N/A
+ */
+template <typename R>
+int flagShift ( const R* keys, size_t n )
+{
+    typedef typename RecordTraits<R>::Bits Bits;
+
+    if ( n == 0 )
+        return -1;
+
+    Bits first = RecordTraits<R>::bits ( keys[0] ), differ = 0;
+    for ( size_t i = 1; i < n; i++ )
+        differ |= RecordTraits<R>::bits ( keys[i] ) ^ first;
+
+    int shift = -1;
+    for ( int bit = 0; differ != 0; bit++, differ >>= 1 )
+        shift = bit - bit % RADIX_BITS;
+
+    return shift;
+}
+
+ /**flagCount
+ *@fn void flagCount ( const R* keys, size_t n, int shift, size_t* counts )
+ *@brief Adds up how many records have each value of the digit at shift
+ *@param keys The records
+ *@param n The number of records
+ *@param shift The lowest bit of the digit
+ *@param counts The counts, added to
+ *@return N/A
+ *@pre counts holds RADIX_SIZE entries
+ *@post counts includes these records
+ */
+template <typename R>
+void flagCount ( const R* keys, size_t n, int shift, size_t* counts )
+{
+    for ( size_t i = 0; i < n; i++ )
+        counts[( RecordTraits<R>::bits ( keys[i] ) >> shift ) & ( RADIX_SIZE - 1 )]++;
+}
+
+ /**flagPermute
+ *@fn void flagPermute ( R* keys, int shift, const size_t* counts, size_t* bucketStarts )
+ *@brief One American flag pass. Each record that is not where its digit belongs is swapped into the next free place
+ *       of its bucket, and the one it displaces is moved on the same way until the cycle comes back, so the records
+ *       are put in order of the digit within the array they are in.
+ *@param keys The records
+ *@param shift The lowest bit of the digit
+ *@param counts How many records have each value of the digit
+ *@param bucketStarts Where the start of each bucket is stored, with the end last
+ *@return N/A
+ *@pre counts holds RADIX_SIZE entries that add up to the number of records and bucketStarts holds RADIX_SIZE + 1
+ *@post The records are in order of the digit, not stably
+ */
+template <typename R>
+void flagPermute ( R* keys, int shift, const size_t* counts, size_t* bucketStarts )
+{
+    size_t next[RADIX_SIZE];
+
+    bucketStarts[0] = 0;
+    for ( int digit = 0; digit < RADIX_SIZE; digit++ )
+    {
+        next[digit] = bucketStarts[digit];
+        bucketStarts[digit + 1] = bucketStarts[digit] + counts[digit];
+    }
+
+    for ( int digit = 0; digit < RADIX_SIZE; digit++ )
+    {
+        while ( next[digit] < bucketStarts[digit + 1] )
+        {
+            R record = keys[next[digit]];
+            int home = ( RecordTraits<R>::bits ( record ) >> shift ) & ( RADIX_SIZE - 1 );
+
+            //Follow the cycle until a record that belongs here turns up
+            while ( home != digit )
+            {
+                std::swap ( record, keys[next[home]++] );
+                home = ( RecordTraits<R>::bits ( record ) >> shift ) & ( RADIX_SIZE - 1 );
+            }
+
+            keys[next[digit]++] = record;
+        }
+    }
+}
+
+ /**flagSort
+ *@fn void flagSort ( R* keys, size_t n, int shift )
+ *@brief American flag sort from the digit at shift down. Buckets under RADIX_MIN records finish with introsort.
+ *@param keys The records
+ *@param n The number of records
+ *@param shift The lowest bit of the digit to start with
+ *@return N/A
+ *@pre The records agree on every digit above shift
+ *@post keys is sorted
+ */
+template <typename R>
+void flagSort ( R* keys, size_t n, int shift )
+{
+    if ( n < RADIX_MIN )
+    {
+        int depth = 0;
+        for ( size_t i = n; i > 1; i >>= 1 )
+            depth += 2;
+        introSort ( keys, n, depth, false );
+        return;
+    }
+
+    size_t counts[RADIX_SIZE] = { 0 }, bucketStarts[RADIX_SIZE + 1];
+    flagCount ( keys, n, shift, counts );
+
+    //Every record has the same digit, go straight to the next one
+    if ( counts[( RecordTraits<R>::bits ( keys[0] ) >> shift ) & ( RADIX_SIZE - 1 )] == n )
+    {
+        if ( shift > 0 )
+            flagSort ( keys, n, shift - RADIX_BITS );
+        return;
+    }
+
+    flagPermute ( keys, shift, counts, bucketStarts );
+
+    for ( int digit = 0; shift > 0 && digit < RADIX_SIZE; digit++ )
+        flagSort ( keys + bucketStarts[digit], bucketStarts[digit + 1] - bucketStarts[digit], shift - RADIX_BITS );
+}
+
+ /**americanFlagSort
+ *@fn void americanFlagSort ( R* keys, size_t n )
+ *@brief In-place MSD radix sort, the records are only ever swapped within keys so no scratch is needed
+ *@param keys The records
+ *@param n The number of records
+ *@return N/A
+ *@pre keys holds n records
+ *@post keys is sorted, records with equal keys in no particular order
+ */
+template <typename R>
+void americanFlagSort ( R* keys, size_t n )
+{
+    int shift = flagShift ( keys, n );
+
+    if ( shift >= 0 )
+        flagSort ( keys, n, shift );
+}
+
+ /**localSort
+ *@fn void localSort ( R* keys, size_t n, SortKind kind )
+ *@brief Sorts records in ascending key order with the given strategy, or one picked by size for SORT_AUTO. Each record
+ *       type gets its own copy of every strategy, so nothing is decided per key at run time.
+ *@param keys The records
+ *@param n The number of records
+ *@param kind The strategy
+ *@return N/A
+ *@pre keys holds n records
+ *@post keys is sorted
+ */
+template <typename R>
+void localSort ( R* keys, size_t n, SortKind kind )
+{
+    if ( n < 2 )
+        return;
+
+    //Two times log2 n is the usual introsort depth limit
+    int depth = 0;
+    for ( size_t i = n; i > 1; i >>= 1 )
+        depth += 2;
+
+    switch ( kind )
+    {
+        case SORT_RADIX:
+            radixSort ( keys, n );
+            break;
+        case SORT_INTRO:
+            introSort ( keys, n, depth, false );
+            break;
+        case SORT_NETWORK:
+            introSort ( keys, n, depth, true );
+            break;
+        case SORT_FLAG:
+            americanFlagSort ( keys, n );
+            break;
+        case SORT_AUTO:
+            if ( n <= NETWORK_MAX )
+                networkSort ( keys, n, NetworkTag<RecordTraits<R>::PLAIN> (  ) );
+            else if ( n < RADIX_MIN )
+                introSort ( keys, n, depth, true );
+            else
+                radixSort ( keys, n );
+            break;
+    }
+}
+
+ /**localSort
+ *@fn void localSort ( std::vector<R>& keys, SortKind kind )
+ *@brief Sorts a bucket held in a vector
+ *@param keys The bucket
+ *@param kind The strategy
+ *@return N/A
+ *@pre N/A
+ *@post keys is sorted
+ */
+template <typename R>
+void localSort ( std::vector<R>& keys, SortKind kind )
+{
+    if ( !keys.empty (  ) )
+        localSort ( keys.data (  ), keys.size (  ), kind );
+}
+
+ /**mergeRuns
+ *@fn void mergeRuns ( std::vector<R>& keys, std::vector<size_t>& runStarts )
+ *@brief Merges sorted runs pairwise until one is left, log2 of the number of runs passes over the records
+ *@param keys The runs, back to back
+ *@param runStarts The start of each run
+ *@return N/A
+ *@pre Each run is sorted
+ *@post keys is sorted and runStarts holds the single run
+ */
+template <typename R>
+void mergeRuns ( std::vector<R>& keys, std::vector<size_t>& runStarts )
+{
+    std::vector<R> scratch ( keys.size (  ) );
+
+    while ( runStarts.size (  ) > 1 )
+    {
+        std::vector<size_t> merged;
+
+        for ( size_t i = 0; i < runStarts.size (  ); i += 2 )
+        {
+            size_t first = runStarts[i];
+            size_t middle = i + 1 < runStarts.size (  ) ? runStarts[i + 1] : keys.size (  );
+            size_t last = i + 2 < runStarts.size (  ) ? runStarts[i + 2] : keys.size (  );
+
+            std::merge ( keys.begin (  ) + first, keys.begin (  ) + middle, keys.begin (  ) + middle, keys.begin (  ) + last,
+                         scratch.begin (  ) + first, keyLess<R> );
+            merged.push_back ( first );
+        }
+
+        keys.swap ( scratch );
+        runStarts.swap ( merged );
+    }
+}
+
+#endif
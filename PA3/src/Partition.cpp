@@ -0,0 +1,122 @@
+/** @file Partition.cpp
+  * @brief Splits int keys into buckets by value range with a counting pass, a prefix sum and a scatter through
+  *        write-combining buffers, so every bucket ends up as a range of one contiguous array
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.2
+  */
+
+#include "Partition.h"
+#include "Tuner.h"
+
+using namespace std;
+
+ /**partitionKeys
+ *@fn void partitionKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, int* out, vector<size_t>& bucketStarts )
+ *@brief Puts key k in bucket min ( k / bucketWidth, numBuckets - 1 ), see partitionRecords
+ *@param keys The keys, none negative
+ *@param n The number of keys
+ *@param numBuckets The number of buckets
+ *@param bucketWidth The range of keys each bucket holds
+ *@param out Where the buckets are written, back to back
+ *@param bucketStarts Where the start of each bucket in out is stored, with n last
+ *@return N/A
+ *@pre out holds n keys
+ *@post Bucket i is out[bucketStarts[i]] up to out[bucketStarts[i + 1]], in the order the keys came in
+ */
+void partitionKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, int* out, vector<size_t>& bucketStarts )
+{
+    RangeBuckets<int> bucketOf = { bucketWidth, numBuckets };
+    partitionRecords ( keys, n, numBuckets, bucketOf, out, bucketStarts );
+}
+
+ /**countKeys
+ *@fn void countKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, size_t* counts )
+ *@brief The counting pass of partitionKeys
+ *@param keys The keys, none negative
+ *@param n The number of keys
+ *@param numBuckets The number of buckets
+ *@param bucketWidth The range of keys each bucket holds
+ *@param counts Where the number of keys in each bucket is stored
+ *@return N/A
+ *@pre counts holds numBuckets entries
+ *@post counts[i] is the number of keys in bucket i
+ */
+void countKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, size_t* counts )
+{
+    RangeBuckets<int> bucketOf = { bucketWidth, numBuckets };
+    countRecords ( keys, n, numBuckets, bucketOf, counts );
+}
+
+ /**scatterKeys
+ *@fn void scatterKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, int* out, size_t* next )
+ *@brief The scatter pass of partitionKeys
+ *@param keys The keys, none negative
+ *@param n The number of keys
+ *@param numBuckets The number of buckets
+ *@param bucketWidth The range of keys each bucket holds
+ *@param out Where the buckets are written
+ *@param next Where the next key of each bucket goes in out
+ *@return N/A
+ *@pre next leaves room in out for every key of each bucket
+ *@post The keys are in out and next is past the last key written to each bucket
+ */
+void scatterKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, int* out, size_t* next )
+{
+    RangeBuckets<int> bucketOf = { bucketWidth, numBuckets };
+    scatterRecords ( keys, n, numBuckets, bucketOf, out, next );
+}
+
+ /**passesFor
+ *@fn int passesFor ( int numBuckets, int fanOut )
+ *@brief How many passes partitionPasses takes to make numBuckets buckets at most fanOut at a time
+ *@param numBuckets The number of buckets
+ *@param fanOut The most buckets a pass may make
+ *@return The number of passes, at least 1
+ *@pre fanOut > 1
+ *@post N/A
+ */
+int passesFor ( int numBuckets, int fanOut )
+{
+    int passes = 1;
+    for ( long long span = fanOut; span < numBuckets; span *= fanOut )
+        passes++;
+
+    return passes;
+}
+
+ /**bucketSortKeys
+ *@fn void bucketSortKeys ( const int* keys, size_t n, int low, int high, int numBuckets, SortKind kind, int* out )
+ *@brief Bucket sorts keys from low up to high into out. The buckets are split by value at the fan-out tuned for this
+ *       machine, in as many passes as that takes, and each bucket is then sorted where it landed.
+ *@param keys The keys, from low up to high
+ *@param n The number of keys
+ *@param low The smallest key there can be
+ *@param high One more than the largest key there can be
+ *@param numBuckets The number of buckets, 0 for enough that each one fits in L2
+ *@param kind How each bucket is sorted
+ *@param out Where the sorted keys are written
+ *@return N/A
+ *@pre out holds n keys and does not overlap keys
+ *@post out holds the keys in ascending order
+ */
+void bucketSortKeys ( const int* keys, size_t n, int low, int high, int numBuckets, SortKind kind, int* out )
+{
+    if ( numBuckets <= 0 )
+        numBuckets = cacheBuckets ( n * sizeof ( int ) );
+
+    //Every bucket covers at least one key
+    long long range = (long long)high - low;
+    if ( numBuckets > range )
+        numBuckets = range > 0 ? range : 1;
+
+    int fanOut = partitionFanOut (  );
+    OffsetBuckets<int> bucketOf = { low, (int)( ( range + numBuckets - 1 ) / numBuckets ), numBuckets };
+    vector<int> scratch ( passesFor ( numBuckets, fanOut ) > 1 ? n : 0 );
+    vector<size_t> bucketStarts;
+
+    partitionPasses ( keys, n, numBuckets, fanOut, bucketOf, out, scratch.data (  ), bucketStarts );
+
+    for ( int i = 0; i < numBuckets; i++ )
+        localSort ( out + bucketStarts[i], bucketStarts[i + 1] - bucketStarts[i], kind );
+}
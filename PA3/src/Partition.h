@@ -0,0 +1,233 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <vector>
+#include <cstddef>
+#include <string.h>
+#include <algorithm>
+#include "KeyTraits.h"
+#include "LocalSort.h"
+
+//Bytes staged per bucket before they are written out, one cache line
+#define COMBINE_BYTES   64
+
+//Puts a record in bucket min ( key / width, numBuckets - 1 ), for keys of 0 or more
+template <typename R>
+struct RangeBuckets
+{
+    typename RecordTraits<R>::Key width;
+    int numBuckets;
+
+    int operator() ( const R& record ) const
+    {
+        typename RecordTraits<R>::Key bucket = RecordTraits<R>::key ( record ) / width;
+        return bucket < numBuckets - 1 ? (int)bucket : numBuckets - 1;
+    }
+};
+
+//Puts a record in bucket min ( ( key - low ) / width, numBuckets - 1 ), for keys of low or more
+template <typename R>
+struct OffsetBuckets
+{
+    typename RecordTraits<R>::Key low;
+    typename RecordTraits<R>::Key width;
+    int numBuckets;
+
+    int operator() ( const R& record ) const
+    {
+        typename RecordTraits<R>::Key bucket = ( RecordTraits<R>::key ( record ) - low ) / width;
+        return bucket < numBuckets - 1 ? (int)bucket : numBuckets - 1;
+    }
+};
+
+//One digit of the bucket a record is in, the digit one pass of partitionPasses splits on
+template <typename BucketOf>
+struct DigitOf
+{
+    BucketOf bucketOf;
+    int divisor;
+    int fanOut;
+
+    template <typename R>
+    int operator() ( const R& record ) const
+    {
+        return bucketOf ( record ) / divisor % fanOut;
+    }
+};
+
+int passesFor ( int numBuckets, int fanOut );
+void bucketSortKeys ( const int* keys, size_t n, int low, int high, int numBuckets, SortKind kind, int* out );
+void countKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, size_t* counts );
+void scatterKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, int* out, size_t* next );
+void partitionKeys ( const int* keys, size_t n, int numBuckets, int bucketWidth, int* out, std::vector<size_t>& bucketStarts );
+
+ /**countRecords
+ *@fn void countRecords ( const R* records, size_t n, int numBuckets, BucketOf bucketOf, size_t* counts )
+ *@brief The counting pass of partitionRecords
+ *@param records The records
+ *@param n The number of records
+ *@param numBuckets The number of buckets
+ *@param bucketOf Gives the bucket of a record
+ *@param counts Where the number of records in each bucket is stored
+ *@return N/A
+ *@pre counts holds numBuckets entries
+ *@post counts[i] is the number of records in bucket i
+ */
+template <typename R, typename BucketOf>
+void countRecords ( const R* records, size_t n, int numBuckets, BucketOf bucketOf, size_t* counts )
+{
+    std::fill ( counts, counts + numBuckets, 0 );
+
+    for ( size_t i = 0; i < n; i++ )
+        counts[bucketOf ( records[i] )]++;
+}
+
+ /**scatterRecords
+ *@fn void scatterRecords ( const R* records, size_t n, int numBuckets, BucketOf bucketOf, R* out, size_t* next )
+ *@brief The scatter pass of partitionRecords. Records are staged a cache line at a time per bucket and written out a
+ *       whole line at once, so the scatter streams full lines instead of touching numBuckets lines for every record.
+ *@param records The records
+ *@param n The number of records
+ *@param numBuckets The number of buckets
+ *@param bucketOf Gives the bucket of a record
+ *@param out Where the buckets are written
+ *@param next Where the next record of each bucket goes in out
+ *@return N/A
+ *@pre next leaves room in out for every record of each bucket
+ *@post The records are in out and next is past the last record written to each bucket
+ */
+template <typename R, typename BucketOf>
+void scatterRecords ( const R* records, size_t n, int numBuckets, BucketOf bucketOf, R* out, size_t* next )
+{
+    const int line = sizeof ( R ) < COMBINE_BYTES ? COMBINE_BYTES / sizeof ( R ) : 1;
+
+    std::vector<R> staged ( (size_t)numBuckets * line );
+    std::vector<int> filled ( numBuckets, 0 );
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        int bucket = bucketOf ( records[i] );
+        R* stage = &staged[(size_t)bucket * line];
+
+        stage[filled[bucket]++] = records[i];
+
+        if ( filled[bucket] == line )
+        {
+            std::copy ( stage, stage + line, out + next[bucket] );
+            next[bucket] += line;
+            filled[bucket] = 0;
+        }
+    }
+
+    //Flush what is left in each buffer
+    for ( int bucket = 0; bucket < numBuckets; bucket++ )
+    {
+        std::copy ( &staged[(size_t)bucket * line], &staged[(size_t)bucket * line] + filled[bucket], out + next[bucket] );
+        next[bucket] += filled[bucket];
+    }
+}
+
+ /**partitionRecords
+ *@fn void partitionRecords ( const R* records, size_t n, int numBuckets, BucketOf bucketOf, R* out, std::vector<size_t>& bucketStarts )
+ *@brief The first pass counts each bucket, the prefix sum of the counts gives where each bucket starts in out, and the
+ *       second pass scatters the records
+ *@param records The records
+ *@param n The number of records
+ *@param numBuckets The number of buckets
+ *@param bucketOf Gives the bucket of a record
+ *@param out Where the buckets are written, back to back
+ *@param bucketStarts Where the start of each bucket in out is stored, with n last
+ *@return N/A
+ *@pre out holds n records
+ *@post Bucket i is out[bucketStarts[i]] up to out[bucketStarts[i + 1]], in the order the records came in
+ */
+template <typename R, typename BucketOf>
+void partitionRecords ( const R* records, size_t n, int numBuckets, BucketOf bucketOf, R* out, std::vector<size_t>& bucketStarts )
+{
+    //Count
+    std::vector<size_t> counts ( numBuckets );
+    countRecords ( records, n, numBuckets, bucketOf, counts.data (  ) );
+
+    //Prefix sum
+    bucketStarts.resize ( numBuckets + 1 );
+    bucketStarts[0] = 0;
+    for ( int i = 0; i < numBuckets; i++ )
+        bucketStarts[i + 1] = bucketStarts[i] + counts[i];
+
+    //Scatter
+    std::vector<size_t> next ( bucketStarts.begin (  ), bucketStarts.end (  ) - 1 );
+    scatterRecords ( records, n, numBuckets, bucketOf, out, next.data (  ) );
+}
+
+ /**partitionPasses
+ *@fn void partitionPasses ( const R* records, size_t n, int numBuckets, int fanOut, BucketOf bucketOf, R* out, R* scratch, std::vector<size_t>& bucketStarts )
+ *@brief partitionRecords for more buckets than one pass should make. The bucket numbers are split into digits, the
+ *       same number of them as passes, and each pass splits every range the last one made on the next digit, most
+ *       significant first. The passes go back and forth between out and scratch so the last one lands in out.
+ *@param records The records
+ *@param n The number of records
+ *@param numBuckets The number of buckets
+ *@param fanOut The most buckets a pass may make
+ *@param bucketOf Gives the bucket of a record
+ *@param out Where the buckets are written, back to back
+ *@param scratch Room for the passes before the last, or NULL if there is only one pass
+ *@param bucketStarts Where the start of each bucket in out is stored, with n last
+ *@return N/A
+ *@pre out holds n records, and so does scratch if passesFor ( numBuckets, fanOut ) > 1
+ *@post Bucket i is out[bucketStarts[i]] up to out[bucketStarts[i + 1]], in the order the records came in
+ */
+template <typename R, typename BucketOf>
+void partitionPasses ( const R* records, size_t n, int numBuckets, int fanOut, BucketOf bucketOf, R* out, R* scratch,
+                       std::vector<size_t>& bucketStarts )
+{
+    int passes = passesFor ( numBuckets, fanOut );
+
+    if ( passes == 1 )
+    {
+        partitionRecords ( records, n, numBuckets, bucketOf, out, bucketStarts );
+        return;
+    }
+
+    //Spread the digits evenly, the fewest buckets a pass that still covers every bucket in this many passes
+    int digits = 1, divisor = 1;
+    for ( long long span = 1; span < numBuckets; )
+    {
+        digits++;
+        span = 1;
+        for ( int pass = 0; pass < passes; pass++ )
+            span *= digits;
+    }
+    for ( int pass = 1; pass < passes; pass++ )
+        divisor *= digits;
+
+    //An odd number of passes starts in out, an even number in scratch
+    const R* from = records;
+    R* to = passes % 2 ? out : scratch;
+    std::vector<size_t> bounds ( 1, 0 ), next, starts;
+    bounds.push_back ( n );
+
+    for ( int pass = 0; pass < passes; pass++, divisor /= digits )
+    {
+        DigitOf<BucketOf> digitOf = { bucketOf, divisor, digits };
+        next.assign ( 1, 0 );
+
+        for ( size_t range = 0; range + 1 < bounds.size (  ); range++ )
+        {
+            size_t first = bounds[range];
+            partitionRecords ( from + first, bounds[range + 1] - first, digits, digitOf, to + first, starts );
+
+            for ( int digit = 1; digit <= digits; digit++ )
+                next.push_back ( first + starts[digit] );
+        }
+
+        bounds.swap ( next );
+        from = to;
+        to = to == out ? scratch : out;
+    }
+
+    //Bucket numbers past numBuckets - 1 are never used, so their ranges are empty and at the end
+    bucketStarts.assign ( bounds.begin (  ), bounds.begin (  ) + numBuckets );
+    bucketStarts.push_back ( n );
+}
+
+#endif
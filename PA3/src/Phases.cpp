@@ -0,0 +1,148 @@
+/** @file Phases.cpp
+  * @brief Where the time goes. Each rank charges the time since the last mark to whichever phase just ended, and
+  *        counts the bytes it sends to every rank. At the end every phase and every destination is reduced to
+  *        its min, max and mean over the ranks, so skew, the network and the sort itself can be told apart.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Phases.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+//What this rank has measured since startPhases
+struct PhaseLog
+{
+    double seconds[NUM_PHASES];
+    vector<long long> bytesTo;
+    double mark;
+};
+
+static PhaseLog phaseLog;
+
+//How each phase is named in the CSV file
+static const char* phaseNames[NUM_PHASES] = { "load", "partition", "counts", "exchange", "sort", "output" };
+
+ /**startPhases
+ *@fn void startPhases ( int numRanks )
+ *@brief Zeroes every phase and byte count and starts timing
+ *@param numRanks The number of ranks bytes can be sent to
+ *@return N/A
+ *@pre MPI is initialized
+ *@post The next endPhase is charged the time from now
+ */
+void startPhases ( int numRanks )
+{
+    fill ( phaseLog.seconds, phaseLog.seconds + NUM_PHASES, 0.0 );
+    phaseLog.bytesTo.assign ( numRanks, 0 );
+    phaseLog.mark = MPI_Wtime (  );
+}
+
+ /**markPhase
+ *@fn void markPhase (  )
+ *@brief Restarts the clock without charging any phase, e.g. after waiting at a barrier
+ *@return N/A
+ *@pre startPhases was called
+ *@post The next endPhase is charged the time from now
+ */
+void markPhase (  )
+{
+    phaseLog.mark = MPI_Wtime (  );
+}
+
+ /**endPhase
+ *@fn void endPhase ( Phase phase )
+ *@brief Adds the time since the last mark to phase, so a phase that happens more than once is summed
+ *@param phase The phase that just ended
+ *@return N/A
+ *@pre startPhases was called
+ *@post The next endPhase is charged the time from now
+ */
+void endPhase ( Phase phase )
+{
+    double now = MPI_Wtime (  );
+    phaseLog.seconds[phase] += now - phaseLog.mark;
+    phaseLog.mark = now;
+}
+
+ /**countBytesSent
+ *@fn void countBytesSent ( int rank, long long bytes )
+ *@brief Adds bytes to what this rank has sent rank, which can be itself. Nothing is counted before startPhases.
+ *@param rank Where the bytes went
+ *@param bytes How many bytes
+ *@return N/A
+ *@pre N/A
+ *@post The bytes are counted
+ */
+void countBytesSent ( int rank, long long bytes )
+{
+    if ( rank < (int)phaseLog.bytesTo.size (  ) )
+        phaseLog.bytesTo[rank] += bytes;
+}
+
+ /**reportPhases
+ *@fn bool reportPhases ( const char* fileName, long long totalNums, MPI_Comm comm )
+ *@brief Reduces every phase's time and the bytes sent to each rank to their min, max and mean over the ranks, and the
+ *       master appends one line per phase and one per destination to fileName, with a header if the file is new.
+ *       A line is `ranks,totalNums,seconds,phase,min,max,mean,imbalance` or the same with bytes and the destination
+ *       rank, where the imbalance is the max over the mean. This is collective.
+ *@param fileName The CSV file to append to
+ *@param totalNums The number of keys sorted
+ *@param comm The ranks that were timed
+ *@return false on every rank if the file could not be opened
+ *@pre Every rank in comm calls this after the same phases
+ *@post The master has appended the lines
+ */
+bool reportPhases ( const char* fileName, long long totalNums, MPI_Comm comm )
+{
+    int rank, numRanks;
+    MPI_Comm_rank ( comm, &rank );
+    MPI_Comm_size ( comm, &numRanks );
+
+    //The phases and then the bytes to each rank, bytes are exact in a double up to 2^53
+    int numValues = NUM_PHASES + numRanks;
+    vector<double> values ( numValues ), low ( numValues ), high ( numValues ), sum ( numValues );
+
+    copy ( phaseLog.seconds, phaseLog.seconds + NUM_PHASES, values.begin (  ) );
+    for ( int i = 0; i < numRanks; i++ )
+        values[NUM_PHASES + i] = i < (int)phaseLog.bytesTo.size (  ) ? phaseLog.bytesTo[i] : 0;
+
+    MPI_Reduce ( values.data (  ), low.data (  ), numValues, MPI_DOUBLE, MPI_MIN, 0, comm );
+    MPI_Reduce ( values.data (  ), high.data (  ), numValues, MPI_DOUBLE, MPI_MAX, 0, comm );
+    MPI_Reduce ( values.data (  ), sum.data (  ), numValues, MPI_DOUBLE, MPI_SUM, 0, comm );
+
+    int opened = 1;
+    if ( rank == 0 )
+    {
+        //Only a new file gets the header
+        bool fresh = ifstream ( fileName ).peek (  ) == ifstream::traits_type::eof (  );
+        ofstream out ( fileName, ios::app );
+        opened = out.is_open (  );
+
+        if ( opened && fresh )
+            out << "ranks,totalNums,measure,part,min,max,mean,imbalance" << endl;
+
+        for ( int i = 0; opened && i < numValues; i++ )
+        {
+            double mean = sum[i] / numRanks;
+
+            out << numRanks << "," << totalNums << ",";
+
+            //Bytes are whole numbers, which a double would print in exponent form past a million
+            if ( i < NUM_PHASES )
+                out << "seconds," << phaseNames[i] << "," << low[i] << "," << high[i] << "," << mean;
+            else
+                out << "bytes," << i - NUM_PHASES << "," << (long long)low[i] << "," << (long long)high[i] << "," << (long long)( mean + 0.5 );
+
+            out << "," << ( mean > 0 ? high[i] / mean : 1.0 ) << endl;
+        }
+    }
+
+    MPI_Bcast ( &opened, 1, MPI_INT, 0, comm );
+
+    return opened;
+}
@@ -0,0 +1,36 @@
+#ifndef PHASES_H
+#define PHASES_H
+
+#include "mpi.h"
+
+//The parts of a sort that are timed on every rank
+enum Phase
+{
+    //Reading or making up the keys
+    PHASE_LOAD,
+
+    //Splitting the keys into a bucket per rank, and finding heavy keys, splitters or packing the buckets
+    PHASE_PARTITION,
+
+    //Telling every rank how much is coming
+    PHASE_COUNTS,
+
+    //Moving the keys
+    PHASE_EXCHANGE,
+
+    //Sorting and merging, before or after the exchange
+    PHASE_SORT,
+
+    //Writing the sorted keys
+    PHASE_OUTPUT,
+
+    NUM_PHASES
+};
+
+void startPhases ( int numRanks );
+void markPhase (  );
+void endPhase ( Phase phase );
+void countBytesSent ( int rank, long long bytes );
+bool reportPhases ( const char* fileName, long long totalNums, MPI_Comm comm );
+
+#endif
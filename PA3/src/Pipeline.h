@@ -0,0 +1,176 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <vector>
+#include <cstddef>
+#include <deque>
+#include "mpi.h"
+#include "KeyTraits.h"
+#include "LocalSort.h"
+#include "Phases.h"
+
+//Records per block, the unit that is sent, received and sorted
+#define PIPELINE_BLOCK  4096
+
+//Blocks a rank has on their way before it waits for the oldest to arrive
+#define PIPELINE_SENDS  16
+
+//The tag blocks are sent with, an empty block means the sender is done
+#define PIPELINE_TAG    1
+
+ /**receiveBlock
+ *@fn int receiveBlock ( bool wait, SortKind kind, std::vector<R>& bigBucket, std::vector<size_t>& runStarts )
+ *@brief Receives a block if one has arrived, or waits for one, and sorts it onto the end of bigBucket
+ *@param wait Whether to block until a block arrives
+ *@param kind How the block is sorted
+ *@param bigBucket The records received so far
+ *@param runStarts Where each sorted block starts in bigBucket
+ *@return -1 if nothing had arrived, 1 if the sender said it was done, otherwise 0
+ *@pre N/A
+ *@post A block taken is a sorted run on the end of bigBucket
+ */
+template <typename R>
+int receiveBlock ( bool wait, SortKind kind, std::vector<R>& bigBucket, std::vector<size_t>& runStarts )
+{
+    MPI_Status status;
+    int arrived = 1, count;
+
+    if ( wait )
+        MPI_Probe ( MPI_ANY_SOURCE, PIPELINE_TAG, MPI_COMM_WORLD, &status );
+    else
+        MPI_Iprobe ( MPI_ANY_SOURCE, PIPELINE_TAG, MPI_COMM_WORLD, &arrived, &status );
+
+    if ( !arrived )
+        return -1;
+
+    MPI_Get_count ( &status, RecordTraits<R>::datatype (  ), &count );
+
+    size_t start = bigBucket.size (  );
+    bigBucket.resize ( start + count );
+    MPI_Recv ( bigBucket.data (  ) + start, count, RecordTraits<R>::datatype (  ), status.MPI_SOURCE, PIPELINE_TAG,
+               MPI_COMM_WORLD, MPI_STATUS_IGNORE );
+
+    if ( count == 0 )
+        return 1;
+
+    localSort ( bigBucket.data (  ) + start, count, kind );
+    runStarts.push_back ( start );
+
+    return 0;
+}
+
+ /**pipelinedSort
+ *@fn void pipelinedSort ( const R* keys, size_t n, int numRanks, int taskid, BucketOf bucketOf, SortKind kind, std::vector<R>& bigBucket )
+ *@brief Partitioning, the exchange and sorting overlap. Records are dealt into a block per rank, a full block goes
+ *       out with MPI_Isend straight away, and after each one this rank takes in whatever blocks have arrived and
+ *       sorts them. A sent block is freed once its send finishes, and with PIPELINE_SENDS on their way the rank
+ *       keeps taking in blocks until the oldest is done. When every rank has said it is done the sorted blocks are
+ *       merged. This is collective.
+ *@param keys This rank's records
+ *@param n The number of records
+ *@param numRanks The number of ranks
+ *@param taskid This rank
+ *@param bucketOf Gives the rank a record goes to
+ *@param kind How each block is sorted
+ *@param bigBucket Where the records for this rank are stored
+ *@return N/A
+ *@pre Every rank calls this with its own records
+ *@post bigBucket holds this rank's records, sorted
+ */
+template <typename R, typename BucketOf>
+void pipelinedSort ( const R* keys, size_t n, int numRanks, int taskid, BucketOf bucketOf, SortKind kind, std::vector<R>& bigBucket )
+{
+    //The block being filled for each rank, and the blocks being sent, oldest first, which keep their memory until the sends are done
+    std::vector< std::vector<R> > filling ( numRanks );
+    std::deque< std::vector<R> > inFlight;
+    std::deque<MPI_Request> requests;
+    std::vector<size_t> runStarts;
+    int done = 0;
+
+    bigBucket.clear (  );
+
+    for ( size_t i = 0; i <= n; i++ )
+    {
+        //After the last record every rank gets what is left and then an empty block
+        bool last = i == n;
+        int first = last ? 0 : bucketOf ( keys[i] );
+        int end = last ? numRanks : first + 1;
+
+        if ( !last )
+        {
+            filling[first].push_back ( keys[i] );
+            if ( filling[first].size (  ) < PIPELINE_BLOCK )
+                continue;
+        }
+
+        for ( int rank = first; rank < end; rank++ )
+        {
+            std::vector<R>& block = filling[rank];
+
+            if ( rank == taskid )
+            {
+                //Our own block skips MPI
+                countBytesSent ( rank, block.size (  ) * sizeof ( R ) );
+                if ( !block.empty (  ) )
+                {
+                    runStarts.push_back ( bigBucket.size (  ) );
+                    bigBucket.insert ( bigBucket.end (  ), block.begin (  ), block.end (  ) );
+                    localSort ( bigBucket.data (  ) + runStarts.back (  ), block.size (  ), kind );
+                }
+                block.clear (  );
+                continue;
+            }
+
+            if ( !block.empty (  ) )
+            {
+                inFlight.push_back ( std::vector<R> (  ) );
+                inFlight.back (  ).swap ( block );
+                countBytesSent ( rank, inFlight.back (  ).size (  ) * sizeof ( R ) );
+                requests.push_back ( MPI_REQUEST_NULL );
+                MPI_Isend ( inFlight.back (  ).data (  ), inFlight.back (  ).size (  ), RecordTraits<R>::datatype (  ), rank,
+                            PIPELINE_TAG, MPI_COMM_WORLD, &requests.back (  ) );
+            }
+
+            //Say we are done
+            if ( last )
+            {
+                inFlight.push_back ( std::vector<R> (  ) );
+                requests.push_back ( MPI_REQUEST_NULL );
+                MPI_Isend ( NULL, 0, RecordTraits<R>::datatype (  ), rank, PIPELINE_TAG, MPI_COMM_WORLD, &requests.back (  ) );
+            }
+        }
+
+        //Free the blocks whose sends are done, and with too many on their way take in blocks until the oldest is, since
+        //its receiver may be waiting on us the same way
+        while ( !requests.empty (  ) )
+        {
+            int sent;
+            MPI_Test ( &requests.front (  ), &sent, MPI_STATUS_IGNORE );
+
+            if ( sent )
+            {
+                requests.pop_front (  );
+                inFlight.pop_front (  );
+            }
+            else if ( requests.size (  ) > PIPELINE_SENDS )
+                done += std::max ( receiveBlock ( false, kind, bigBucket, runStarts ), 0 );
+            else
+                break;
+        }
+
+        //Sort whatever has come in while we were partitioning
+        for ( int got; !last && ( got = receiveBlock ( false, kind, bigBucket, runStarts ) ) >= 0; )
+            done += got;
+    }
+
+    //Take in the rest
+    while ( done < numRanks - 1 )
+        done += receiveBlock ( true, kind, bigBucket, runStarts );
+
+    for ( size_t i = 0; i < requests.size (  ); i++ )
+        MPI_Wait ( &requests[i], MPI_STATUS_IGNORE );
+
+    mergeRuns ( bigBucket, runStarts );
+}
+
+#endif
@@ -0,0 +1,188 @@
+/** @file Random.cpp
+  * @brief Made up keys from the Philox4x32-10 counter based generator. Key i is a function of i and the seed alone,
+  *        so any slice of the keys can be made on its own and every rank count makes the same keys.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Random.h"
+#include <string.h>
+#include <math.h>
+
+using namespace std;
+
+//The Philox multipliers and the Weyl sequence that bumps the key each round
+#define PHILOX_M0       0xD2511F53u
+#define PHILOX_M1       0xCD9E8D57u
+#define PHILOX_W0       0x9E3779B9u
+#define PHILOX_W1       0xBB67AE85u
+#define PHILOX_ROUNDS   10
+
+//2 ^ 32, to turn 32 random bits into a fraction
+#define TWO_32          4294967296.0
+
+ /**parseDistribution
+ *@fn bool parseDistribution ( const char* name, Distribution& distribution )
+ *@brief Turns uniform, zipf, gaussian, sorted, reverse, few or equal into a Distribution
+ *@param name The name of the distribution
+ *@param distribution Where the distribution is stored
+ *@return false if the name is not a distribution
+ *@pre N/A
+ *@post distribution is set if true is returned
+ */
+bool parseDistribution ( const char* name, Distribution& distribution )
+{
+    for ( int i = DIST_UNIFORM; i <= DIST_EQUAL; i++ )
+    {
+        if ( strcmp ( name, distributionName ( (Distribution)i ) ) == 0 )
+        {
+            distribution = (Distribution)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ /**distributionName
+ *@fn const char* distributionName ( Distribution distribution )
+ *@brief The name parseDistribution accepts for a distribution
+ *@param distribution The distribution
+ *@return The name
+ *@pre N/A
+ *@post N/A
+ */
+const char* distributionName ( Distribution distribution )
+{
+    switch ( distribution )
+    {
+        case DIST_ZIPF:     return "zipf";
+        case DIST_GAUSSIAN: return "gaussian";
+        case DIST_SORTED:   return "sorted";
+        case DIST_REVERSE:  return "reverse";
+        case DIST_FEW:      return "few";
+        case DIST_EQUAL:    return "equal";
+        default:            return "uniform";
+    }
+}
+
+ /**philox
+ *@fn void philox ( unsigned long long counter, unsigned long long seed, unsigned int out[4] )
+ *@brief Philox4x32-10: ten rounds of multiplies and xors that turn a counter and a seed into 128 random bits
+ *@param counter Which block of bits, usually the index of the key
+ *@param seed The seed
+ *@param out Where the bits are stored
+ *@return N/A
+ *@pre N/A
+ *@post out holds the bits for counter and seed
+ */
+void philox ( unsigned long long counter, unsigned long long seed, unsigned int out[4] )
+{
+    unsigned int c0 = (unsigned int)counter, c1 = (unsigned int)( counter >> 32 ), c2 = 0, c3 = 0;
+    unsigned int k0 = (unsigned int)seed, k1 = (unsigned int)( seed >> 32 );
+
+    for ( int round = 0; round < PHILOX_ROUNDS; round++ )
+    {
+        unsigned long long product0 = (unsigned long long)PHILOX_M0 * c0;
+        unsigned long long product1 = (unsigned long long)PHILOX_M1 * c2;
+
+        c0 = (unsigned int)( product1 >> 32 ) ^ c1 ^ k0;
+        c1 = (unsigned int)product1;
+        c2 = (unsigned int)( product0 >> 32 ) ^ c3 ^ k1;
+        c3 = (unsigned int)product0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+ /**generateKeys
+ *@fn void generateKeys ( int* keys, long long first, size_t n, long long totalNums, int max, Distribution distribution, unsigned long long seed )
+ *@brief Makes up keys first to first + n - 1 of totalNums keys from 0 to max - 1
+ *@param keys Where the keys are stored
+ *@param first The index of the first key
+ *@param n The number of keys
+ *@param totalNums The number of keys in all, which the sorted and reverse distributions are spread over
+ *@param max One more than the largest key
+ *@param distribution How the keys are spread
+ *@param seed The seed
+ *@return N/A
+ *@pre keys holds n ints and max > 0
+ *@post keys holds the keys, the same ones whichever slice they were made in
+ */
+void generateKeys ( int* keys, long long first, size_t n, long long totalNums, int max, Distribution distribution,
+                    unsigned long long seed )
+{
+    //Zipf by inverting the continuous CDF of x ^ -s over 1 to max + 1
+    double zipfPower = 1.0 - ZIPF_EXPONENT;
+    double zipfScale = pow ( (double)max + 1.0, zipfPower ) - 1.0;
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+        long long index = first + i;
+        unsigned int bits[4];
+        long long key;
+
+        philox ( index, seed, bits );
+
+        switch ( distribution )
+        {
+            case DIST_ZIPF:
+            {
+                double u = ( bits[0] + 0.5 ) / TWO_32;
+                key = (long long)pow ( 1.0 + u * zipfScale, 1.0 / zipfPower ) - 1;
+                break;
+            }
+            case DIST_GAUSSIAN:
+            {
+                //Box-Muller
+                double u = ( bits[0] + 0.5 ) / TWO_32, v = bits[1] / TWO_32;
+                double normal = sqrt ( -2.0 * log ( u ) ) * cos ( 2.0 * M_PI * v );
+                key = (long long)floor ( max / 2.0 + normal * max / GAUSSIAN_SPREAD );
+                break;
+            }
+            case DIST_SORTED:
+                key = index * max / totalNums;
+                break;
+            case DIST_REVERSE:
+                key = ( totalNums - 1 - index ) * max / totalNums;
+                break;
+            case DIST_FEW:
+                key = ( ( (unsigned long long)bits[0] * FEW_UNIQUE ) >> 32 ) * max / FEW_UNIQUE;
+                break;
+            case DIST_EQUAL:
+                key = max / 2;
+                break;
+            default:
+                //The top bits of the product, which unlike % does not favour small keys
+                key = ( (unsigned long long)bits[0] * max ) >> 32;
+                break;
+        }
+
+        keys[i] = key < 0 ? 0 : key >= max ? max - 1 : (int)key;
+    }
+}
+
+ /**sliceOf
+ *@fn void sliceOf ( long long totalNums, int numRanks, int rank, long long& first, long long& count )
+ *@brief The keys a rank makes up when totalNums are split as evenly as they go
+ *@param totalNums The number of keys
+ *@param numRanks The number of ranks
+ *@param rank The rank
+ *@param first Where the index of its first key is stored
+ *@param count Where its number of keys is stored
+ *@return N/A
+ *@pre 0 <= rank < numRanks
+ *@post The slices of all the ranks cover every key once, in rank order
+ */
+void sliceOf ( long long totalNums, int numRanks, int rank, long long& first, long long& count )
+{
+    first = totalNums * rank / numRanks;
+    count = totalNums * ( rank + 1 ) / numRanks - first;
+}
@@ -0,0 +1,49 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+
+//The seed used when none is given
+#define DEFAULT_SEED    1
+
+//How many distinct keys the few-unique distribution uses
+#define FEW_UNIQUE      16
+
+//The Zipf exponent, key k is about ( k + 1 ) ^ -ZIPF_EXPONENT as likely as key 0
+#define ZIPF_EXPONENT   1.1
+
+//The Gaussian is centred on max / 2 with a standard deviation of max / GAUSSIAN_SPREAD
+#define GAUSSIAN_SPREAD 8
+
+//How the made up keys are spread over 0 to max - 1
+enum Distribution
+{
+    DIST_UNIFORM,
+
+    //Small keys are the most common, key 0 most of all
+    DIST_ZIPF,
+
+    //Clamped to the range
+    DIST_GAUSSIAN,
+
+    //Already in ascending order, evenly spaced
+    DIST_SORTED,
+
+    //In descending order
+    DIST_REVERSE,
+
+    //FEW_UNIQUE values, evenly spaced
+    DIST_FEW,
+
+    //Every key is max / 2
+    DIST_EQUAL
+};
+
+bool parseDistribution ( const char* name, Distribution& distribution );
+const char* distributionName ( Distribution distribution );
+void philox ( unsigned long long counter, unsigned long long seed, unsigned int out[4] );
+void generateKeys ( int* keys, long long first, size_t n, long long totalNums, int max, Distribution distribution,
+                    unsigned long long seed );
+void sliceOf ( long long totalNums, int numRanks, int rank, long long& first, long long& count );
+
+#endif
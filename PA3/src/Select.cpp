@@ -0,0 +1,295 @@
+/** @file Select.cpp
+  * @brief Finds keys by their rank in sorted order without sorting. Every rank histograms its keys into
+  *        SELECT_BUCKETS ranges, the histograms are summed, and only the ranges holding a wanted rank are looked at
+  *        again, so a 32 bit key is found in four passes at most, each one over fewer keys than the last, and any
+  *        number of ranks share the passes.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Select.h"
+#include "Partition.h"
+#include "LocalSort.h"
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+//Puts a key in bucket ( key - low ) >> shift, in long long so a range can span every int
+struct SelectBuckets
+{
+    long long low;
+    int shift;
+
+    int operator() ( int key ) const
+    {
+        return ( key - low ) >> shift;
+    }
+};
+
+static void selectIn ( const int* keys, size_t n, long long low, long long high, vector<long long>& ranks,
+                       const vector<int>& queries, vector<int>& values, MPI_Comm comm );
+
+ /**parsePercentiles
+ *@fn bool parsePercentiles ( const char* list, vector<double>& percentiles )
+ *@brief Reads a comma separated list of percentiles such as 50,90,99.9
+ *@param list The list
+ *@param percentiles Where the percentiles are stored
+ *@return false if an entry is not a number from 0 to 100
+ *@pre N/A
+ *@post percentiles holds the list if true is returned
+ */
+bool parsePercentiles ( const char* list, vector<double>& percentiles )
+{
+    percentiles.clear (  );
+
+    while ( *list )
+    {
+        char* end;
+        double percentile = strtod ( list, &end );
+
+        if ( end == list || percentile < 0 || percentile > 100 || ( *end != ',' && *end != '\0' ) )
+            return false;
+
+        percentiles.push_back ( percentile );
+        list = *end == ',' ? end + 1 : end;
+    }
+
+    return !percentiles.empty (  );
+}
+
+ /**selectRank
+ *@fn int selectRank ( const int* keys, size_t n, long long rank, MPI_Comm comm )
+ *@brief The key that would be at position rank if every rank's keys were sorted together. This is collective.
+ *@param keys This rank's keys
+ *@param n The number of keys
+ *@param rank The position wanted, from 0
+ *@param comm The ranks holding the keys
+ *@return The key, the same on every rank
+ *@pre 0 <= rank < the number of keys over all the ranks
+ *@post N/A
+ */
+int selectRank ( const int* keys, size_t n, long long rank, MPI_Comm comm )
+{
+    vector<long long> ranks ( 1, rank );
+    vector<int> values;
+
+    selectRanks ( keys, n, ranks, values, comm );
+
+    return values[0];
+}
+
+ /**selectRanks
+ *@fn void selectRanks ( const int* keys, size_t n, const vector<long long>& ranks, vector<int>& values, MPI_Comm comm )
+ *@brief The keys at several positions of every rank's keys sorted together, found together so each pass over the
+ *       keys serves all of them. This is collective.
+ *@param keys This rank's keys
+ *@param n The number of keys
+ *@param ranks The positions wanted, from 0
+ *@param values Where the key at each position is stored
+ *@param comm The ranks holding the keys
+ *@return N/A
+ *@pre Every position is less than the number of keys over all the ranks
+ *@post values is the same on every rank
+ */
+void selectRanks ( const int* keys, size_t n, const vector<long long>& ranks, vector<int>& values, MPI_Comm comm )
+{
+    //The range of the keys, the minimum negated so one MPI_MAX finds both
+    long long range[2] = { -0x7fffffffLL - 1, -0x7fffffffLL - 1 };
+    for ( size_t i = 0; i < n; i++ )
+    {
+        range[0] = max ( range[0], -(long long)keys[i] );
+        range[1] = max ( range[1], (long long)keys[i] );
+    }
+    MPI_Allreduce ( MPI_IN_PLACE, range, 2, MPI_LONG_LONG, MPI_MAX, comm );
+
+    vector<long long> remaining ( ranks );
+    vector<int> queries;
+    for ( size_t i = 0; i < ranks.size (  ); i++ )
+        queries.push_back ( i );
+
+    values.resize ( ranks.size (  ) );
+    selectIn ( keys, n, -range[0], range[1], remaining, queries, values, comm );
+}
+
+ /**selectPercentiles
+ *@fn bool selectPercentiles ( const int* keys, size_t n, const vector<double>& percentiles, vector<int>& values, MPI_Comm comm )
+ *@brief The key at each percentile of every rank's keys together, by the nearest rank method. This is collective.
+ *@param keys This rank's keys
+ *@param n The number of keys
+ *@param percentiles The percentiles, from 0 to 100
+ *@param values Where the key at each percentile is stored
+ *@param comm The ranks holding the keys
+ *@return false on every rank if there are no keys on any rank
+ *@pre Every rank in comm calls this
+ *@post values is the same on every rank, and empty if false is returned
+ */
+bool selectPercentiles ( const int* keys, size_t n, const vector<double>& percentiles, vector<int>& values, MPI_Comm comm )
+{
+    long long total = n;
+    MPI_Allreduce ( MPI_IN_PLACE, &total, 1, MPI_LONG_LONG, MPI_SUM, comm );
+
+    //No keys have no range to split, and no percentiles
+    values.clear (  );
+    if ( total == 0 )
+        return false;
+
+    vector<long long> ranks;
+    for ( size_t i = 0; i < percentiles.size (  ); i++ )
+        ranks.push_back ( max ( (long long)ceil ( percentiles[i] / 100 * total ) - 1, 0LL ) );
+
+    selectRanks ( keys, n, ranks, values, comm );
+
+    return true;
+}
+
+ /**smallestKeys
+ *@fn void smallestKeys ( const int* keys, size_t n, int k, int root, MPI_Comm comm, vector<int>& smallest )
+ *@brief The k smallest keys over every rank. Each rank keeps its own k smallest in a max-heap in one pass, the heaps
+ *       are gathered on root as sorted runs, and root merges them and keeps the first k. This is collective.
+ *@param keys This rank's keys
+ *@param n The number of keys
+ *@param k How many keys are wanted
+ *@param root The rank the keys end up on
+ *@param comm The ranks holding the keys
+ *@param smallest Where root stores the keys, in ascending order
+ *@return N/A
+ *@pre k > 0
+ *@post smallest holds the k smallest keys, or all of them if there are fewer, on root and nothing elsewhere
+ */
+void smallestKeys ( const int* keys, size_t n, int k, int root, MPI_Comm comm, vector<int>& smallest )
+{
+    int taskid, numRanks;
+    MPI_Comm_rank ( comm, &taskid );
+    MPI_Comm_size ( comm, &numRanks );
+
+    //The largest of the k smallest so far is on top, and a smaller key takes its place
+    int kept = min ( (size_t)k, n );
+    vector<int> heap ( keys, keys + kept );
+    make_heap ( heap.begin (  ), heap.end (  ) );
+    for ( size_t i = kept; i < n; i++ )
+    {
+        if ( keys[i] < heap.front (  ) )
+        {
+            pop_heap ( heap.begin (  ), heap.end (  ) );
+            heap.back (  ) = keys[i];
+            push_heap ( heap.begin (  ), heap.end (  ) );
+        }
+    }
+    sort_heap ( heap.begin (  ), heap.end (  ) );
+
+    vector<int> counts ( numRanks ), displacements ( numRanks );
+    MPI_Gather ( &kept, 1, MPI_INT, counts.data (  ), 1, MPI_INT, root, comm );
+
+    int total = 0;
+    vector<size_t> runStarts;
+    for ( int i = 0; taskid == root && i < numRanks; i++ )
+    {
+        displacements[i] = total;
+        runStarts.push_back ( total );
+        total += counts[i];
+    }
+
+    smallest.resize ( total );
+    MPI_Gatherv ( heap.data (  ), kept, MPI_INT, smallest.data (  ), counts.data (  ), displacements.data (  ), MPI_INT,
+                  root, comm );
+
+    if ( taskid == root )
+    {
+        mergeRuns ( smallest, runStarts );
+        smallest.resize ( min ( total, k ) );
+    }
+}
+
+ /**selectIn
+ *@fn void selectIn ( const int* keys, size_t n, long long low, long long high, vector<long long>& ranks, const vector<int>& queries, vector<int>& values, MPI_Comm comm )
+ *@brief One pass of selection. The range is split into at most SELECT_BUCKETS buckets a power of two wide, every rank
+ *       counts its keys into them and the counts are summed with MPI_Allreduce. Each bucket a wanted position falls
+ *       in is kept, one more pass copies every rank's keys in kept buckets out, and each kept bucket is searched the
+ *       same way. Every rank sums the same counts, so they all keep the same buckets in the same order. This is
+ *       collective.
+ *@param keys This rank's keys in the range
+ *@param n The number of keys
+ *@param low The smallest key in the range
+ *@param high The largest key in the range
+ *@param ranks The position of each query, relative to the start of the range once it is in it
+ *@param queries The queries whose positions are in this range
+ *@param values Where the key each query wants is stored
+ *@param comm The ranks holding the keys
+ *@return N/A
+ *@pre The positions of queries are inside the range
+ *@post values holds the key of each query in queries
+ */
+static void selectIn ( const int* keys, size_t n, long long low, long long high, vector<long long>& ranks,
+                       const vector<int>& queries, vector<int>& values, MPI_Comm comm )
+{
+    if ( low == high )
+    {
+        for ( size_t q = 0; q < queries.size (  ); q++ )
+            values[queries[q]] = low;
+        return;
+    }
+
+    SelectBuckets bucketOf = { low, 0 };
+    while ( ( ( high - low ) >> bucketOf.shift ) >= SELECT_BUCKETS )
+        bucketOf.shift++;
+    int numBuckets = ( ( high - low ) >> bucketOf.shift ) + 1;
+
+    //Count and sum
+    vector<size_t> counts ( numBuckets );
+    countRecords ( keys, n, numBuckets, bucketOf, counts.data (  ) );
+
+    vector<long long> totals ( counts.begin (  ), counts.end (  ) );
+    MPI_Allreduce ( MPI_IN_PLACE, totals.data (  ), numBuckets, MPI_LONG_LONG, MPI_SUM, comm );
+
+    //The bucket each query is in, with its position from the start of that bucket
+    vector<long long> bucketStarts ( numBuckets + 1, 0 );
+    for ( int bucket = 0; bucket < numBuckets; bucket++ )
+        bucketStarts[bucket + 1] = bucketStarts[bucket] + totals[bucket];
+
+    vector<int> slot ( numBuckets, -1 ), kept;
+    vector< vector<int> > keptQueries;
+    for ( size_t q = 0; q < queries.size (  ); q++ )
+    {
+        long long& rank = ranks[queries[q]];
+        int bucket = upper_bound ( bucketStarts.begin (  ), bucketStarts.end (  ), rank ) - bucketStarts.begin (  ) - 1;
+        rank -= bucketStarts[bucket];
+
+        if ( slot[bucket] < 0 )
+        {
+            slot[bucket] = kept.size (  );
+            kept.push_back ( bucket );
+            keptQueries.push_back ( vector<int> (  ) );
+        }
+        keptQueries[slot[bucket]].push_back ( queries[q] );
+    }
+
+    //Copy out the keys of the kept buckets in one pass
+    vector< vector<int> > keptKeys ( kept.size (  ) );
+    for ( size_t k = 0; k < kept.size (  ); k++ )
+        keptKeys[k].reserve ( counts[kept[k]] );
+    for ( size_t i = 0; i < n; i++ )
+    {
+        int k = slot[bucketOf ( keys[i] )];
+        if ( k >= 0 )
+            keptKeys[k].push_back ( keys[i] );
+    }
+
+    //The kept buckets in bucket order, the same on every rank
+    vector<int> order ( kept.size (  ) );
+    for ( size_t k = 0; k < kept.size (  ); k++ )
+        order[k] = k;
+    sort ( order.begin (  ), order.end (  ), [&] ( int a, int b ) { return kept[a] < kept[b]; } );
+
+    for ( size_t o = 0; o < order.size (  ); o++ )
+    {
+        int k = order[o];
+        long long bucketLow = low + ( (long long)kept[k] << bucketOf.shift );
+        long long bucketHigh = min ( high, bucketLow + ( 1LL << bucketOf.shift ) - 1 );
+
+        selectIn ( keptKeys[k].data (  ), keptKeys[k].size (  ), bucketLow, bucketHigh, ranks, keptQueries[k], values, comm );
+        vector<int> (  ).swap ( keptKeys[k] );
+    }
+}
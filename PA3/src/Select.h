@@ -0,0 +1,17 @@
+#ifndef SELECT_H
+#define SELECT_H
+
+#include <vector>
+#include <cstddef>
+#include "mpi.h"
+
+//Buckets each selection pass splits the remaining key range into
+#define SELECT_BUCKETS  1024
+
+bool parsePercentiles ( const char* list, std::vector<double>& percentiles );
+int selectRank ( const int* keys, size_t n, long long rank, MPI_Comm comm );
+void selectRanks ( const int* keys, size_t n, const std::vector<long long>& ranks, std::vector<int>& values, MPI_Comm comm );
+bool selectPercentiles ( const int* keys, size_t n, const std::vector<double>& percentiles, std::vector<int>& values, MPI_Comm comm );
+void smallestKeys ( const int* keys, size_t n, int k, int root, MPI_Comm comm, std::vector<int>& smallest );
+
+#endif
@@ -1,8 +1,10 @@
 /** @file Sequential.cpp
-  * @brief A sequential implementation of Bucket Sort. 
+  * @brief A sequential implementation of Bucket Sort. Keys are made up or mapped from a key file, bucketed with a
+  *        counting pass and each bucket finished by a pluggable local sort, on one thread or many, or sorted in place
+  *        with the American flag sort.
   * @author Tyler DeFoor
-  * @date 3/28/2017
-  * @version 1.0
+  * @date 10/19/2026
+  * @version 2.0
   */
  
 #include <iostream>
@@ -11,88 +13,150 @@
 #include <string.h>
 #include <vector>
 #include <algorithm>
+#include <unistd.h>
 #include "mpi.h"
+#include "LocalSort.h"
+#include "Partition.h"
+#include "ThreadSort.h"
+#include "KeyFile.h"
+#include "Random.h"
+#include "Tuner.h"
 
 #define MASTER      0
 #define INT_TYPE    MPI_INT
 
 using namespace std;
 
-void bucketsort ( int* unsorted, int* &sorted, int max, int numBuckets, int totalNums );
-void bubbleSort(vector<int>& a);
+//What the command line asked for
+struct RunOptions
+{
+    //How many keys to make up, or the key file to read them from
+    long long totalNums;
+    const char* inputFile;
+
+    //How the made up keys are spread and the seed they come from
+    Distribution distribution;
+    unsigned long long seed;
+
+    //The key file the sorted keys are written to, or NULL
+    const char* outputFile;
+
+    SortKind sortKind;
+
+    //0 for the single threaded sort
+    int numThreads;
+
+    //0 for enough buckets that each fits in L2
+    int numBuckets;
+
+    //Whether to sort in one array with the American flag sort instead of bucket sorting into a second one
+    bool inPlace;
+};
+
+void bucketsort ( const int* unsorted, int* &sorted, int max, int numBuckets, long long totalNums, SortKind sortKind );
+bool parseArguments ( int argc, char** argv, RunOptions& run );
 
 int main ( int argc, char** argv )
 {
 
     /* Variable Declarations */
-    //The filename
-    //char* filename = argv[1];
-    
-    //Get total nums for random number generation
-    int totalNums = atoi(argv[1]);
+    //Get total nums for random number generation or the key file, how to sort each bucket and how many threads to sort with
+    RunOptions run;
+
+    if ( !parseArguments ( argc, argv, run ) )
+    {
+        cerr << "Usage: " << argv[0] << " [-t threads] [-b buckets | -i] [-k auto|radix|intro|network|flag] [-g uniform|zipf|gaussian|sorted|reverse|few|equal] [-s seed]\n"
+             << "         totalNums | -f keyFile [-o sortedFile]" << endl;
+        return 1;
+    }
+
+    long long totalNums = run.totalNums;
 
     //The total number of buckets
-    int numBuckets = 10;
+    int numBuckets = run.numBuckets;
 
     //The max of the numbers
     int max = 100000;
 
-    //The unsorted array of ints
-    int* unsorted;
+    //The unsorted array of ints, either made up or mapped from the key file
+    int* generated = NULL;
+    const int* unsorted;
     int* sorted;
+    KeyMap keyMap;
 
     //The start, end, and total time
     double start, end, total;
 
-    numBuckets = 10;
-    //Can put in another argument to set number of buckets
-    /*
-    if ( argc == 3 )
-        numBuckets = atoi(argv[2]);
-    */
-    //File I/O - More like FUN I/O
-    ifstream fin;
-
     /* End of Variable Declarations */
 
     //Initialize MPI
     MPI_Init ( &argc, &argv );
 
-    /*
-    //A try catch for opening files because I'm a good programmer
-    try
+    if ( run.inputFile )
     {
-        fin.open ( filename );
+        //Map the file, the keys are paged in as the partition reads them
+        if ( !mapKeyFile ( run.inputFile, keyMap ) )
+        {
+            cerr << "Could not read " << run.inputFile << endl;
+            MPI_Finalize (  );
+            return 1;
+        }
+
+        unsorted = keyMap.keys;
+        totalNums = keyMap.count;
+
+        //Buckets are by value, so the keys have to start at 0 and the max comes from the file
+        max = 0;
+        for ( long long i = 0; i < totalNums; i++ )
+        {
+            if ( unsorted[i] < 0 || unsorted[i] == 0x7fffffff )
+            {
+                cerr << "Keys must be from 0 up to 2147483646" << endl;
+                MPI_Finalize (  );
+                return 1;
+            }
+
+            if ( unsorted[i] >= max )
+                max = unsorted[i] + 1;
+        }
     }
-    catch ( const ifstream::failure& e )
+    else
     {
-        cout << "File failure: Try again later" << endl;
-    }
+        generated = new int[totalNums];
 
-    //Get the total number of ints
-    fin >> totalNums;
-    */
-   
-    unsorted = new int[totalNums];
-    sorted = new int[totalNums];
+        //Make up the numbers, the same ones Dynamic makes up from the same seed
+        generateKeys ( generated, 0, totalNums, totalNums, max, run.distribution, run.seed );
 
-    //Read in the numbers
-    for ( int i = 0; i < totalNums; i++ )
-    {
-        //fin >> unsorted[i];
-        unsorted[i] = (rand (  ) % max);
+        unsorted = generated;
+        max += 10;
     }
 
-    max += 10;
+    //Sorting in place needs one array, the made up keys or a copy of the file's
+    if ( run.inPlace )
+    {
+        sorted = generated ? generated : new int[totalNums];
+        if ( !generated )
+            copy ( unsorted, unsorted + totalNums, sorted );
+        generated = NULL;
+    }
+    else
+        sorted = new int[totalNums];
 
-    //Close the file
-    //fin.close (  );
+    //Tune the fan-out before the timer, it is only timed the first time on a machine
+    partitionFanOut (  );
 
     //Start the timer
     start = MPI_Wtime (  );
 
-    //Bucket sort everything
-    bucketsort ( unsorted, sorted, max, numBuckets, totalNums );
+    //Bucket sort everything, or flag sort it in place, on every core if threads were asked for
+    if ( run.inPlace && run.numThreads > 0 )
+        inPlaceSort ( sorted, totalNums, run.numThreads );
+    else if ( run.inPlace )
+        americanFlagSort ( sorted, totalNums );
+    else if ( run.numThreads > 0 )
+        threadedBucketSort ( unsorted, sorted, totalNums, max, run.numThreads, run.sortKind );
+    else
+        bucketsort ( unsorted, sorted, max, numBuckets, totalNums, run.sortKind );
 
     //End the timer
     end = MPI_Wtime (  );
@@ -101,7 +165,17 @@ int main ( int argc, char** argv )
     total = end - start;
 
     //Output the time for totalNums
-    cout << "1 " << totalNums << " " << total << endl;
+    cout << ( run.numThreads > 0 ? run.numThreads : 1 ) << " " << totalNums << " " << total << endl;
+
+    //Write the sorted keys
+    if ( run.outputFile && !writeKeyFile ( run.outputFile, sorted, totalNums ) )
+        cerr << "Could not write " << run.outputFile << endl;
+
+    if ( run.inputFile )
+        unmapKeyFile ( keyMap );
+
+    delete [] generated;
+    delete [] sorted;
 
     //Finalize MPI
     MPI_Finalize();
@@ -110,73 +184,100 @@ int main ( int argc, char** argv )
 }
 
  /**bucketsort
- *@fn bucketsort ( int* unsorted, int* &sorted, int max, int numBuckets, int totalNums )
- *@brief Sorts unsorted using bucketsort into sorted
+ *@fn bucketsort ( const int* unsorted, int* &sorted, int max, int numBuckets, long long totalNums, SortKind sortKind )
+ *@brief Sorts unsorted using bucketsort into sorted, partitioning in as many passes as the tuned fan-out needs
  *@param unsorted The unsorted list of numbers
  *@param sorted The sorted list of numbers
  *@param max The maximum number
- *@param numBuckets The number of buckets
+ *@param numBuckets The number of buckets, 0 for enough that each fits in L2
  *@param totalNums The number of elements in the array
+ *@param sortKind How each bucket is sorted
  *@return N/A
  *@pre unsorted and sorted are allocated and unsorted holds relevant data
  *@post sorted contains all of the numbers of unsorted, but sorted
  */
-void bucketsort ( int* unsorted, int* &sorted, int max, int numBuckets, int totalNums )
+void bucketsort ( const int* unsorted, int* &sorted, int max, int numBuckets, long long totalNums, SortKind sortKind )
 {
-    //The bucket the number is supposed to go to
-    int myBucket = max / numBuckets;
-
-    //Create a vector of ints because vectors are great
-    vector<int> buckets[numBuckets];
-
-    //Put them in their buckets
-    for ( int i = 0; i < totalNums; i++ ) 
-        buckets[unsorted[i] / myBucket].push_back ( unsorted[i] );
-
-    //The current index
-    int current = 0;
-
-
-    //Loop through all of the buckets
-    for ( int i = 0; i < numBuckets; i++ ) 
-    {
-        //Sort the bucket
-        bubbleSort ( buckets[i] );
-
-        //memcpy it back into the original because its super speedy
-        //Uncomment to turn it on/off
-        //memcpy ( &sorted[current], buckets[i].data (  ), sizeof(int) *buckets[i].size (  ) );
-
-        //Update current index
-        current += buckets[i].size (  );
-    }
-
+    //Put them in their buckets, straight into sorted, and sort each bucket where it is, no copy back needed
+    bucketSortKeys ( unsorted, totalNums, 0, max, numBuckets, sortKind, sorted );
 }
 
- /**bubblesort
- *@fn void bubbleSort(vector<int>& a)
- *@brief Sorts a vector using bubblesort
- *@param a The vector to be sorted
- *@return N/A
- *@pre a contains relevant data
- *@post a is sorted
+ /**parseArguments
+ *@fn bool parseArguments ( int argc, char** argv, RunOptions& run )
+ *@brief Reads [-t threads] [-b buckets | -i] [-k auto|radix|intro|network|flag] [-g distribution] [-s seed] totalNums | -f keyFile
+ *       [-o sortedFile]. -t 0 uses every hardware thread, -b 0 picks the number of buckets from the size of L2 and -i
+ *       sorts in place.
+ *@param argc The argument count
+ *@param argv The arguments
+ *@param run Where the options are stored
+ *@return false if the arguments are not understood
+ *@pre N/A
+ *@post run is filled in if true is returned, single threaded with SORT_AUTO, buckets sized for L2, uniform keys from
+ *      DEFAULT_SEED and no files unless asked for
  */
-void bubbleSort(vector<int>& a)
+bool parseArguments ( int argc, char** argv, RunOptions& run )
 {
-    bool swap = true;
-
-    while(swap)
+    int option;
+
+    run.totalNums = 0;
+    run.inputFile = NULL;
+    run.distribution = DIST_UNIFORM;
+    run.seed = DEFAULT_SEED;
+    run.outputFile = NULL;
+    run.sortKind = SORT_AUTO;
+    run.numThreads = 0;
+    run.numBuckets = 0;
+    run.inPlace = false;
+
+    while ( ( option = getopt ( argc, argv, "k:t:b:if:o:g:s:" ) ) != -1 )
     {
-        swap = false;
-        for (size_t i = 0; i < a.size()-1; i++) 
+        switch ( option )
         {
-            if ( a[i]>a[i+1] )
-            {
-                a[i] += a[i+1];
-                a[i+1] = a[i] - a[i+1];
-                a[i] -=a[i+1];
-                swap = true;
-            }
+            case 'k':
+                if ( !parseSortKind ( optarg, run.sortKind ) )
+                    return false;
+                break;
+            case 't':
+                run.numThreads = atoi ( optarg );
+                if ( run.numThreads < 0 )
+                    return false;
+                if ( run.numThreads == 0 )
+                    run.numThreads = defaultThreads (  );
+                break;
+            case 'b':
+                run.numBuckets = atoi ( optarg );
+                if ( run.numBuckets < 0 )
+                    return false;
+                break;
+            case 'i':
+                run.inPlace = true;
+                break;
+            case 'f':
+                run.inputFile = optarg;
+                break;
+            case 'o':
+                run.outputFile = optarg;
+                break;
+            case 'g':
+                if ( !parseDistribution ( optarg, run.distribution ) )
+                    return false;
+                break;
+            case 's':
+                run.seed = strtoull ( optarg, NULL, 10 );
+                break;
+            default:
+                return false;
         }
     }
+
+    //The keys come from the file or are made up, not both
+    if ( run.inputFile )
+        return argc == optind;
+
+    if ( argc - optind != 1 )
+        return false;
+
+    run.totalNums = atoll ( argv[optind] );
+
+    return run.totalNums > 0;
 }
@@ -0,0 +1,224 @@
+/** @file ThreadSort.cpp
+  * @brief A shared-memory bucket sort on std::thread, so one process can use every core of a node without the
+  *        rank startup and bucket copies of the MPI version
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "ThreadSort.h"
+#include "Partition.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+//A thread's share of the buckets. The owner takes from the front and so do thieves, a fetch_add decides who gets which.
+struct BucketQueue
+{
+    atomic<int> next;
+    int end;
+
+    //Keep each queue on its own cache line so owners do not fight over one
+    char padding[64 - sizeof ( atomic<int> ) - sizeof ( int )];
+};
+
+static void sortBuckets ( int* sorted, const size_t* bucketStarts, vector<BucketQueue>& queues, int self, SortKind kind );
+static bool largerBucket ( const pair<size_t, size_t>& a, const pair<size_t, size_t>& b );
+
+ /**defaultThreads
+ *@fn int defaultThreads (  )
+ *@brief The number of threads to use when none is asked for
+ *@return The number of hardware threads, at least 1
+ *@pre N/A
+ *@post N/A
+ */
+int defaultThreads (  )
+{
+    int threads = thread::hardware_concurrency (  );
+
+    return threads > 0 ? threads : 1;
+}
+
+ /**threadedBucketSort
+ *@fn void threadedBucketSort ( const int* unsorted, int* sorted, size_t n, int max, int numThreads, SortKind kind )
+ *@brief Each thread counts its slice of the keys into its own histogram. Each thread then works out where its keys
+ *       go in every bucket from all the histograms, which needs no lock because every thread only reads them, and
+ *       scatters its slice there. Last the buckets are sorted in place, each thread working through its own buckets
+ *       and then stealing from the others.
+ *@param unsorted The keys, 0 up to max
+ *@param sorted Where the sorted keys are written
+ *@param n The number of keys
+ *@param max One more than the largest key
+ *@param numThreads The number of threads
+ *@param kind How each bucket is sorted
+ *@return N/A
+ *@pre sorted holds n keys
+ *@post sorted holds the keys of unsorted in ascending order
+ */
+void threadedBucketSort ( const int* unsorted, int* sorted, size_t n, int max, int numThreads, SortKind kind )
+{
+    int numBuckets = numThreads * BUCKETS_PER_THREAD;
+    int bucketWidth = max / numBuckets > 0 ? max / numBuckets : 1;
+
+    //Thread t has histogram t, laid out one after another
+    vector<size_t> counts ( numThreads * numBuckets );
+    vector<size_t> bucketStarts ( numBuckets + 1 );
+    vector<BucketQueue> queues ( numThreads );
+    vector<thread> threads;
+
+    //Each thread's slice of the keys
+    vector<size_t> sliceStarts ( numThreads + 1 );
+    for ( int t = 0; t <= numThreads; t++ )
+        sliceStarts[t] = n * t / numThreads;
+
+    //Count
+    for ( int t = 0; t < numThreads; t++ )
+        threads.push_back ( thread ( [&, t] (  )
+        {
+            countKeys ( unsorted + sliceStarts[t], sliceStarts[t + 1] - sliceStarts[t], numBuckets, bucketWidth, &counts[t * numBuckets] );
+        } ) );
+    for ( int t = 0; t < numThreads; t++ )
+        threads[t].join (  );
+    threads.clear (  );
+
+    //Prefix sum and scatter. Thread t's keys for a bucket go after that bucket's keys from threads before it.
+    for ( int t = 0; t < numThreads; t++ )
+        threads.push_back ( thread ( [&, t] (  )
+        {
+            vector<size_t> next ( numBuckets );
+            size_t offset = 0;
+
+            for ( int bucket = 0; bucket < numBuckets; bucket++ )
+            {
+                for ( int other = 0; other < numThreads; other++ )
+                {
+                    if ( other == t )
+                        next[bucket] = offset;
+                    offset += counts[other * numBuckets + bucket];
+                }
+
+                //Thread 0 also records where the buckets start for the sort
+                if ( t == 0 )
+                    bucketStarts[bucket + 1] = offset;
+            }
+
+            scatterKeys ( unsorted + sliceStarts[t], sliceStarts[t + 1] - sliceStarts[t], numBuckets, bucketWidth, sorted, next.data (  ) );
+        } ) );
+    for ( int t = 0; t < numThreads; t++ )
+        threads[t].join (  );
+    threads.clear (  );
+
+    //Sort, thread t starts on buckets t * BUCKETS_PER_THREAD onwards
+    for ( int t = 0; t < numThreads; t++ )
+    {
+        queues[t].next = t * BUCKETS_PER_THREAD;
+        queues[t].end = ( t + 1 ) * BUCKETS_PER_THREAD;
+    }
+
+    for ( int t = 0; t < numThreads; t++ )
+        threads.push_back ( thread ( sortBuckets, sorted, bucketStarts.data (  ), ref ( queues ), t, kind ) );
+    for ( int t = 0; t < numThreads; t++ )
+        threads[t].join (  );
+}
+
+ /**inPlaceSort
+ *@fn void inPlaceSort ( int* keys, size_t n, int numThreads )
+ *@brief American flag sort on numThreads threads with no scratch array. The threads count the top digit of their
+ *       slices together, one pass of swaps puts every key in its top digit's bucket, and the threads then take the
+ *       buckets, largest first, and flag sort each one on its own.
+ *@param keys The keys
+ *@param n The number of keys
+ *@param numThreads The number of threads
+ *@return N/A
+ *@pre N/A
+ *@post keys is sorted
+ */
+void inPlaceSort ( int* keys, size_t n, int numThreads )
+{
+    int shift = flagShift ( keys, n );
+
+    if ( shift < 0 )
+        return;
+
+    //Count, thread t has histogram t
+    vector<size_t> counts ( numThreads * RADIX_SIZE ), total ( RADIX_SIZE ), bucketStarts ( RADIX_SIZE + 1 );
+    vector<thread> threads;
+
+    for ( int t = 0; t < numThreads; t++ )
+        threads.push_back ( thread ( [&, t] (  )
+        {
+            flagCount ( keys + n * t / numThreads, n * ( t + 1 ) / numThreads - n * t / numThreads, shift, &counts[t * RADIX_SIZE] );
+        } ) );
+    for ( int t = 0; t < numThreads; t++ )
+        threads[t].join (  );
+    threads.clear (  );
+
+    for ( int t = 0; t < numThreads; t++ )
+        for ( int digit = 0; digit < RADIX_SIZE; digit++ )
+            total[digit] += counts[t * RADIX_SIZE + digit];
+
+    //The swaps chase cycles through the whole array, so they are one thread's job
+    flagPermute ( keys, shift, total.data (  ), bucketStarts.data (  ) );
+
+    if ( shift == 0 )
+        return;
+
+    //Largest buckets first so the last ones to finish are small
+    vector< pair<size_t, size_t> > buckets;
+    for ( int digit = 0; digit < RADIX_SIZE; digit++ )
+        if ( bucketStarts[digit + 1] > bucketStarts[digit] )
+            buckets.push_back ( make_pair ( bucketStarts[digit], bucketStarts[digit + 1] - bucketStarts[digit] ) );
+    sort ( buckets.begin (  ), buckets.end (  ), largerBucket );
+
+    atomic<size_t> next ( 0 );
+    for ( int t = 0; t < numThreads; t++ )
+        threads.push_back ( thread ( [&] (  )
+        {
+            for ( size_t bucket = next++; bucket < buckets.size (  ); bucket = next++ )
+                flagSort ( keys + buckets[bucket].first, buckets[bucket].second, shift - RADIX_BITS );
+        } ) );
+    for ( int t = 0; t < numThreads; t++ )
+        threads[t].join (  );
+}
+
+ /**sortBuckets
+ *@fn void sortBuckets ( int* sorted, const size_t* bucketStarts, vector<BucketQueue>& queues, int self, SortKind kind )
+ *@brief Sorts this thread's buckets, then steals unsorted buckets from the other threads until there are none left
+ *@param sorted The partitioned keys
+ *@param bucketStarts Where each bucket starts in sorted, with the end last
+ *@param queues Every thread's buckets
+ *@param self This thread
+ *@param kind How each bucket is sorted
+ *@return N/A
+ *@pre Every thread has its queue
+ *@post Every bucket this thread took is sorted
+ */
+static void sortBuckets ( int* sorted, const size_t* bucketStarts, vector<BucketQueue>& queues, int self, SortKind kind )
+{
+    int numThreads = queues.size (  );
+
+    for ( int i = 0; i < numThreads; i++ )
+    {
+        BucketQueue& queue = queues[( self + i ) % numThreads];
+
+        for ( int bucket = queue.next++; bucket < queue.end; bucket = queue.next++ )
+            localSort ( sorted + bucketStarts[bucket], bucketStarts[bucket + 1] - bucketStarts[bucket], kind );
+    }
+}
+
+ /**largerBucket
+ *@fn bool largerBucket ( const pair<size_t, size_t>& a, const pair<size_t, size_t>& b )
+ *@brief Orders buckets, given as start and size, largest first
+ *@param a A bucket
+ *@param b Another bucket
+ *@return Whether a is larger than b
+ *@pre N/A
+ *@post N/A
+ */
+static bool largerBucket ( const pair<size_t, size_t>& a, const pair<size_t, size_t>& b )
+{
+    return a.second > b.second;
+}
@@ -0,0 +1,14 @@
+#ifndef THREADSORT_H
+#define THREADSORT_H
+
+#include <cstddef>
+#include "LocalSort.h"
+
+//Buckets per thread, enough that stealing can even out buckets of different sizes
+#define BUCKETS_PER_THREAD  16
+
+int defaultThreads (  );
+void threadedBucketSort ( const int* unsorted, int* sorted, size_t n, int max, int numThreads, SortKind kind );
+void inPlaceSort ( int* keys, size_t n, int numThreads );
+
+#endif
@@ -0,0 +1,235 @@
+/** @file Tuner.cpp
+  * @brief Picks how many buckets one partition pass should split into. Past a few hundred the write-combining
+  *        buffers fall out of L1 and the bucket pages out of the TLB, and too few wastes passes, so a model of the
+  *        caches gives a starting point, timing it against its neighbours settles it, and the answer is kept per
+  *        machine so the timing only happens once.
+  * @author Tyler DeFoor
+  * @date 10/19/2026
+  * @version 1.0
+  */
+
+#include "Tuner.h"
+#include "Partition.h"
+#include <mpi.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+using namespace std;
+
+static double timePartition ( const int* keys, int* out, size_t n, int fanOut );
+static string tuneFile (  );
+static int tuneFanOut ( const CacheSizes& caches );
+
+ /**cacheSizes
+ *@fn CacheSizes cacheSizes (  )
+ *@brief Asks the system for the L1 and L2 data cache sizes and /proc/cpuinfo for the TLB size. The first call
+ *       asks, later calls return the same answer.
+ *@return The sizes, with the defaults for anything not found
+ *@pre N/A
+ *@post The sizes are cached in memory
+ */
+CacheSizes cacheSizes (  )
+{
+    static bool asked = false;
+    static CacheSizes caches = { DEFAULT_L1, DEFAULT_L2, DEFAULT_TLB };
+
+    if ( asked )
+        return caches;
+    asked = true;
+
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    long l1 = sysconf ( _SC_LEVEL1_DCACHE_SIZE ), l2 = sysconf ( _SC_LEVEL2_CACHE_SIZE );
+    if ( l1 > 0 )
+        caches.l1 = l1;
+    if ( l2 > 0 )
+        caches.l2 = l2;
+#endif
+
+    //Lines like "TLB size : 3072 4K pages"
+    ifstream cpuinfo ( "/proc/cpuinfo" );
+    string line;
+    while ( getline ( cpuinfo, line ) )
+    {
+        if ( line.compare ( 0, 8, "TLB size" ) == 0 && line.find ( ':' ) != string::npos )
+        {
+            long entries = atol ( line.c_str (  ) + line.find ( ':' ) + 1 );
+            if ( entries > 0 )
+                caches.tlbEntries = entries;
+            break;
+        }
+    }
+
+    return caches;
+}
+
+ /**modelFanOut
+ *@fn int modelFanOut ( const CacheSizes& caches )
+ *@brief The largest power of two fan-out whose write-combining buffers take half of L1 at most and whose buckets
+ *       take half of the TLB at most, leaving the rest for the keys being read
+ *@param caches The cache sizes
+ *@return The fan-out, from FANOUT_MIN to FANOUT_MAX
+ *@pre N/A
+ *@post N/A
+ */
+int modelFanOut ( const CacheSizes& caches )
+{
+    size_t limit = min ( caches.l1 / ( 2 * COMBINE_BYTES ), caches.tlbEntries / 2 );
+
+    int fanOut = FANOUT_MIN;
+    while ( fanOut < FANOUT_MAX && (size_t)fanOut * 2 <= limit )
+        fanOut *= 2;
+
+    return fanOut;
+}
+
+ /**partitionFanOut
+ *@fn int partitionFanOut (  )
+ *@brief The fan-out for this machine. On the first call the lowest rank on each node looks for the node in the tune
+ *       file or tunes it, and hands the answer to the other ranks on the node, so they agree and the file gets one
+ *       line. Later calls return the same answer.
+ *@return The fan-out, from FANOUT_MIN to FANOUT_MAX
+ *@pre MPI is initialized, and every rank makes the first call
+ *@post The fan-out is cached in memory and in the tune file
+ */
+int partitionFanOut (  )
+{
+    static int fanOut = 0;
+
+    if ( fanOut > 0 )
+        return fanOut;
+
+    //The ranks sharing this node's memory, and so its caches
+    MPI_Comm node;
+    int nodeRank;
+    MPI_Comm_split_type ( MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node );
+    MPI_Comm_rank ( node, &nodeRank );
+
+    //Every rank asks for its cache sizes here, before any timer, since cacheBuckets needs them too
+    CacheSizes caches = cacheSizes (  );
+    if ( nodeRank == 0 )
+        fanOut = tuneFanOut ( caches );
+
+    MPI_Bcast ( &fanOut, 1, MPI_INT, 0, node );
+    MPI_Comm_free ( &node );
+
+    return fanOut;
+}
+
+ /**tuneFanOut
+ *@fn int tuneFanOut ( const CacheSizes& caches )
+ *@brief Looks for this host in the tune file and, if it is not there, times a partition of TUNE_KEYS keys at the
+ *       model's fan-out and at half and double it, keeps the one that splits the most bits of key a second and adds
+ *       it to the tune file
+ *@param caches The cache sizes
+ *@return The fan-out, from FANOUT_MIN to FANOUT_MAX
+ *@pre Only one rank on the node calls it
+ *@post The fan-out is in the tune file
+ */
+static int tuneFanOut ( const CacheSizes& caches )
+{
+    int fanOut = FANOUT_MIN;
+    char host[256] = "";
+    gethostname ( host, sizeof ( host ) - 1 );
+
+    //Lines are "host l1 l2 tlbEntries fanOut", and a line only counts if the caches still match
+    ifstream fin ( tuneFile (  ).c_str (  ) );
+    string name;
+    size_t l1, l2, tlbEntries;
+    int tuned;
+    while ( fin >> name >> l1 >> l2 >> tlbEntries >> tuned )
+    {
+        if ( name == host && l1 == caches.l1 && l2 == caches.l2 && tlbEntries == caches.tlbEntries &&
+             tuned >= FANOUT_MIN && tuned <= FANOUT_MAX )
+            return tuned;
+    }
+
+    //Keys spread over 2 ^ 30, from a linear congruential generator since only their spread matters
+    vector<int> keys ( TUNE_KEYS ), out ( TUNE_KEYS );
+    unsigned int state = 12345;
+    for ( size_t i = 0; i < keys.size (  ); i++ )
+    {
+        state = state * 1664525u + 1013904223u;
+        keys[i] = state >> 2;
+    }
+
+    int model = modelFanOut ( caches );
+    double best = 0;
+    for ( int candidate = max ( model / 2, FANOUT_MIN ); candidate <= min ( model * 2, FANOUT_MAX ); candidate *= 2 )
+    {
+        //Bits of key resolved a second, the best of two runs
+        double time = min ( timePartition ( keys.data (  ), out.data (  ), keys.size (  ), candidate ),
+                            timePartition ( keys.data (  ), out.data (  ), keys.size (  ), candidate ) );
+        double rate = log2 ( (double)candidate ) / max ( time, 1e-9 );
+
+        if ( rate > best )
+        {
+            best = rate;
+            fanOut = candidate;
+        }
+    }
+
+    ofstream fout ( tuneFile (  ).c_str (  ), ios::app );
+    fout << host << " " << caches.l1 << " " << caches.l2 << " " << caches.tlbEntries << " " << fanOut << endl;
+
+    return fanOut;
+}
+
+ /**cacheBuckets
+ *@fn int cacheBuckets ( size_t bytes )
+ *@brief How many buckets to split bytes of keys into so that each bucket, and the scratch radix sort needs for it,
+ *       take half of L2 at most
+ *@param bytes The size of the keys
+ *@return The number of buckets, at least 1
+ *@pre N/A
+ *@post N/A
+ */
+int cacheBuckets ( size_t bytes )
+{
+    size_t bucketBytes = cacheSizes (  ).l2 / 4;
+
+    return max ( (size_t)1, ( bytes + bucketBytes - 1 ) / bucketBytes );
+}
+
+ /**timePartition
+ *@fn double timePartition ( const int* keys, int* out, size_t n, int fanOut )
+ *@brief Times one partition of keys from 0 to 2 ^ 30 into fanOut buckets
+ *@param keys The keys
+ *@param out Where the buckets are written
+ *@param n The number of keys
+ *@param fanOut The number of buckets
+ *@return The time in seconds
+ *@pre keys and out hold n keys
+ *@post N/A
+ */
+static double timePartition ( const int* keys, int* out, size_t n, int fanOut )
+{
+    RangeBuckets<int> bucketOf = { ( 1 << 30 ) / fanOut, fanOut };
+    vector<size_t> bucketStarts;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now (  );
+    partitionRecords ( keys, n, fanOut, bucketOf, out, bucketStarts );
+
+    return chrono::duration<double> ( chrono::steady_clock::now (  ) - start ).count (  );
+}
+
+ /**tuneFile
+ *@fn string tuneFile (  )
+ *@brief Where the tune file is, in $HOME or, without one, $TMPDIR or /tmp
+ *@return The path
+ *@pre N/A
+ *@post N/A
+ */
+static string tuneFile (  )
+{
+    const char* dir = getenv ( "HOME" );
+    if ( !dir )
+        dir = getenv ( "TMPDIR" ) ? getenv ( "TMPDIR" ) : "/tmp";
+
+    return string ( dir ) + "/" + TUNE_FILE;
+}
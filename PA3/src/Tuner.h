@@ -0,0 +1,36 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <cstddef>
+
+//Sizes used when the machine does not say
+#define DEFAULT_L1      ( 32 << 10 )
+#define DEFAULT_L2      ( 256 << 10 )
+#define DEFAULT_TLB     1024
+
+//Bounds on the buckets of one partition pass
+#define FANOUT_MIN      16
+#define FANOUT_MAX      4096
+
+//Keys partitioned to time each fan-out
+#define TUNE_KEYS       ( 1 << 21 )
+
+//Where tuned fan-outs are kept, in $HOME, one line per machine
+#define TUNE_FILE       ".pa3tune"
+
+//What partitioning has to fit in
+struct CacheSizes
+{
+    size_t l1;
+    size_t l2;
+
+    //Pages the data TLB can map
+    size_t tlbEntries;
+};
+
+CacheSizes cacheSizes (  );
+int modelFanOut ( const CacheSizes& caches );
+int partitionFanOut (  );
+int cacheBuckets ( size_t bytes );
+
+#endif